@@ -118,6 +118,7 @@ typedef struct
     bool is64bInt; // true: int64_t for local indexing, false: int32_t (for local indexing)
     int layers; // Number of layers to use in communication avoiding SpGEMM. 
     int compute;
+    bool fusePrune; // true: prune/select while the columns of the expansion are formed
     
     //debugging
     bool show;
@@ -153,8 +154,9 @@ void InitParam(HipMCLParam & param)
     
     //HipMCL optimization
     param.layers = 1;
-    param.compute = 1; // 1 means hash-based computation, 2 means heap-based computation
+    param.compute = 1; // 0 means the kernel is selected per column, 1 means hash-based computation, 2 means heap-based computation
     param.phases = 1;
+    param.fusePrune = false;
     param.perProcessMem = 0;
     param.isDoublePrecision = true;
     param.is64bInt = true;
@@ -214,8 +216,10 @@ void ShowParam(HipMCLParam & param)
     runinfo << "    Number of layers : " << param.layers << endl;
     runinfo << "    Computation kernel : " << param.compute << endl;
     runinfo << "    Number of phases: " << param.phases << endl;
+    runinfo << "    Fused prune/select in expansion: " << (param.fusePrune ? "yes" : "no") << endl;
     runinfo << "    Memory avilable per process: ";
     if(param.perProcessMem>0) runinfo << param.perProcessMem << "GB" << endl;
+    else if(param.perProcessMem<0) runinfo << "detected at every iteration" << endl;
     else runinfo << "not provided" << endl;
     if(param.isDoublePrecision) runinfo << "Using double precision floating point" << endl;
     else runinfo << "Using single precision floating point" << endl;
@@ -286,6 +290,9 @@ void ProcessParam(int argc, char* argv[], HipMCLParam & param)
 		else if (strcmp(argv[i],"-compute")==0) {
             param.compute = atoi(argv[i + 1]);
         }
+        else if (strcmp(argv[i],"--fuse-prune")==0) {
+            param.fusePrune = true;
+        }
         else if (strcmp(argv[i],"-phases")==0) {
             param.phases = atoi(argv[i + 1]);
         }
@@ -343,9 +350,10 @@ void ShowOptions()
     
     runinfo << "HipMCL optimization" << endl;
     runinfo << "    -layers <number of layers> (default:1)\n";
-    runinfo << "    -compute <1 or 2> (default:1)\n";
+    runinfo << "    -compute <0, 1 or 2> (0: select heap/hash/dense accumulator per column, 1: hash, 2: heap) (default:1)\n";
     runinfo << "    -phases <number of phases> (default:1)\n";
-    runinfo << "    -per-process-mem <memory (GB) available per process> (default:0, number of phases is not estimated)\n";
+    runinfo << "    --fuse-prune : if provided, prune/select/recovery candidates are picked while each column of the expansion is formed, so unpruned columns are never stored (only with -layers 1)\n";
+    runinfo << "    -per-process-mem <memory (GB) available per process> (default:0, number of phases is not estimated; -1: detect available memory of the node)\n";
     runinfo << "    --single-precision (if not provided, use double precision floating point numbers)\n" << endl;
     runinfo << "    --32bit-local-index (if not provided, use 64 bit indexing for vertex ids)\n" << endl;
     
@@ -570,7 +578,7 @@ FullyDistVec<IT, IT> HipMCL(SpParMat<IT,NT,DER> & A, HipMCLParam & param)
         double t1 = MPI_Wtime();
         //A.Square<PTFF>() ;        // expand
 		if(param.layers == 1){
-			A = MemEfficientSpGEMM<PTFF, NT, DER>(A, A, param.phases, param.prunelimit, (IT)param.select, (IT)param.recover_num, param.recover_pct, param.kselectVersion, param.compute, param.perProcessMem);
+			A = MemEfficientSpGEMM<PTFF, NT, DER>(A, A, param.phases, param.prunelimit, (IT)param.select, (IT)param.recover_num, param.recover_pct, param.kselectVersion, param.compute, param.perProcessMem, param.fusePrune);
 		}
 		else{
 			A3D_cs = MemEfficientSpGEMM3D<PTFF, NT, DER, IT, NT, NT, DER, DER >(
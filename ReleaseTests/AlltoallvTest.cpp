@@ -0,0 +1,124 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.5 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <mpi.h>
+#include <sys/time.h> 
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+// Exchanges an irregular pattern (with empty messages) through SpParHelper::Alltoallv and through MPI_Alltoallv, and compares
+template <typename T>
+bool SameAsAlltoallv(MPI_Comm comm, MPI_Datatype type, int round)
+{
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	vector<int> sendcnt(nprocs), recvcnt(nprocs);
+	for(int i=0; i< nprocs; ++i)
+		sendcnt[i] = (myrank * 7 + i * 3 + round) % 5;	// zero for some pairs
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, comm);
+	vector<int> sdispls(nprocs, 0), rdispls(nprocs, 0);
+	partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	int totsend = sdispls[nprocs-1] + sendcnt[nprocs-1];
+	int totrecv = rdispls[nprocs-1] + recvcnt[nprocs-1];
+
+	vector<T> senddata(totsend);
+	for(int i=0; i< nprocs; ++i)
+		for(int k=0; k< sendcnt[i]; ++k)
+			senddata[sdispls[i]+k] = T(myrank, i, k + round);
+	vector<T> recvdata(totrecv), recvcontrol(totrecv);
+	SpParHelper::Alltoallv(senddata.data(), sendcnt.data(), sdispls.data(), type, recvdata.data(), recvcnt.data(), rdispls.data(), type, comm);
+	MPI_Alltoallv(senddata.data(), sendcnt.data(), sdispls.data(), type, recvcontrol.data(), recvcnt.data(), rdispls.data(), type, comm);
+	int same = (recvdata == recvcontrol);
+	int allsame;
+	MPI_Allreduce(&same, &allsame, 1, MPI_INT, MPI_LAND, comm);
+	return allsame;
+}
+
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	{
+		typedef tuple<int64_t,int64_t,double> TRIPLE;
+		MPI_Datatype MPI_triple;
+		MPI_Type_contiguous(sizeof(TRIPLE), MPI_CHAR, &MPI_triple);
+		MPI_Type_commit(&MPI_triple);
+
+		// the node topology is cached on the communicator when it is first needed, so every grouping gets a fresh one
+		const char * groupings[] = {"0", "1", "2", "3"};	// 0: one node per shared memory domain
+		bool nodeok = true;
+		SpParHelper::SetAlltoallvMode(A2A_NODE);
+		for(const char * grouping : groupings)
+		{
+			setenv("COMBBLAS_A2A_NODESIZE", grouping, 1);
+			MPI_Comm comm;
+			MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+			for(int round = 0; round < 3; ++round)
+				nodeok = SameAsAlltoallv<TRIPLE>(comm, MPI_triple, round) && nodeok;
+			MPI_Comm_free(&comm);
+		}
+		unsetenv("COMBBLAS_A2A_NODESIZE");
+		if (nodeok)
+		{
+			SpParHelper::Print("Node aware Alltoallv working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in node aware Alltoallv, go fix it!\n");
+		}
+
+		SpParHelper::SetAlltoallvMode(A2A_SPARSE);
+		bool sparseok = true;
+		for(int round = 0; round < 3; ++round)
+			sparseok = SameAsAlltoallv<TRIPLE>(MPI_COMM_WORLD, MPI_triple, round) && sparseok;
+		if (sparseok)
+		{
+			SpParHelper::Print("Sparse Alltoallv working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in sparse Alltoallv, go fix it!\n");
+		}
+		SpParHelper::SetAlltoallvMode(A2A_AUTO);
+		MPI_Type_free(&MPI_triple);
+	}
+	MPI_Finalize();
+	return 0;
+}
@@ -81,8 +81,9 @@ int main(int argc, char* argv[])
 	{
 		if(myrank == 0)
 		{
-			cout << "Usage: ./genwritemat <Scale> <Edgefactor> <Symmetricize> <outputname>" << endl;
+			cout << "Usage: ./genwritemat <Scale> <Edgefactor> <Symmetricize> <outputname> [insitu]" << endl;
 			cout << "Example: ./genwritemat 25 16 1 scale25_ef16_symmetric.mtx" << endl;
+			cout << "insitu: generate the blocks in place (unpermuted R-MAT, no edge list or redistribution)" << endl;
 		}
 		MPI_Finalize();
 		return -1;
@@ -91,44 +92,58 @@ int main(int argc, char* argv[])
         unsigned scale = static_cast<unsigned>(atoi(argv[1]));
         unsigned edgefactor = static_cast<unsigned>(atoi(argv[2]));
         int symmetric = static_cast<unsigned>(atoi(argv[3]));
-
+        bool insitu = (argc > 5 && string(argv[5]) == "insitu");
 
         double initiator[4] = {.57, .19, .19, .05};
 
+        typedef SpParMat < int64_t, int, SpDCCols<int32_t,int> > PSpMat_s32p64_Int;    // use 32-bits for local matrices, but parallel semantics are 64-bits
+        PSpMat_s32p64_Int * G;
         double t01 = MPI_Wtime();
         double t02;
-        DistEdgeList<int64_t> * DEL = new DistEdgeList<int64_t>();
-        DEL->GenGraph500Data(initiator, scale, edgefactor, true, true );    // generate packed edges
-        SpParHelper::Print("Generated renamed edge lists\n");
-        t02 = MPI_Wtime();
-        ostringstream tinfo;
-        tinfo << "Generation took " << t02-t01 << " seconds" << endl;
-        SpParHelper::Print(tinfo.str());
-        
+        if(insitu)
+        {
+            G = new PSpMat_s32p64_Int(make_shared<CommGrid>(MPI_COMM_WORLD, 0, 0));
+            G->GenerateRMAT(scale, edgefactor, initiator, 1, false);    // keeps self-loops, sums duplicates
+            SpParHelper::Print("Generated Sparse Matrix in place (with int32 local indices and values)\n");
+            t02 = MPI_Wtime();
+            ostringstream tinfo;
+            tinfo << "Generation took " << t02-t01 << " seconds" << endl;
+            SpParHelper::Print(tinfo.str());
+        }
+        else
+        {
+            DistEdgeList<int64_t> * DEL = new DistEdgeList<int64_t>();
+            DEL->GenGraph500Data(initiator, scale, edgefactor, true, true );    // generate packed edges
+            SpParHelper::Print("Generated renamed edge lists\n");
+            t02 = MPI_Wtime();
+            ostringstream tinfo;
+            tinfo << "Generation took " << t02-t01 << " seconds" << endl;
+            SpParHelper::Print(tinfo.str());
 
-        typedef SpParMat < int64_t, int, SpDCCols<int32_t,int> > PSpMat_s32p64_Int;    // use 32-bits for local matrices, but parallel semantics are 64-bits
-        PSpMat_s32p64_Int G(*DEL, false);         // conversion from distributed edge list, keeps self-loops, sums duplicates
-        delete DEL;    // free memory before symmetricizing
-        SpParHelper::Print("Created Sparse Matrix (with int32 local indices and values)\n");
+            G = new PSpMat_s32p64_Int(*DEL, false);         // conversion from distributed edge list, keeps self-loops, sums duplicates
+            delete DEL;    // free memory before symmetricizing
+            SpParHelper::Print("Created Sparse Matrix (with int32 local indices and values)\n");
+        }
     
-        int64_t removed  = G.RemoveLoops();
+        int64_t removed  = G->RemoveLoops();
         ostringstream loopinfo;
         loopinfo << "Removed " << removed << " loops" << endl;
         SpParHelper::Print(loopinfo.str());
-        G.PrintInfo();
+        G->PrintInfo();
         
         if(symmetric)
         {
-            Symmetricize(G);
+            Symmetricize(*G);
             SpParHelper::Print("Symmetricized\n");
         }
         
-        float balance = G.LoadImbalance();
+        float balance = G->LoadImbalance();
         ostringstream outs;
         outs << "Load balance: " << balance << endl;
         SpParHelper::Print(outs.str());
         
-        G.ParallelWriteMM(string(argv[4]), true);   // write one-based
+        G->ParallelWriteMM(string(argv[4]), true);   // write one-based
+        delete G;
 	}
 	MPI_Finalize();
 	return 0;
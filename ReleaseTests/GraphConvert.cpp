@@ -0,0 +1,199 @@
+#include <mpi.h>
+#include <sys/time.h>
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpDCCols < int64_t, double > DCCols;
+typedef SpParMat < int64_t, double, DCCols > PSpMat;
+typedef FullyDistVec < int64_t, array<char, MAXVERTNAME> > NameVec;
+
+
+// How duplicate entries (in the input, or created by symmetrization) are combined
+class Combine
+{
+public:
+	Combine(const string & mode): mode(mode) {}
+
+	double operator()(const double & a, const double & b) const
+	{
+		if(mode == "sum")	return a + b;
+		else if(mode == "min")	return std::min(a, b);
+		else if(mode == "first")	return a;
+		else	return std::max(a, b);
+	}
+
+	// extended form for EWiseApply with nulls allowed on both sides
+	double operator()(const double & a, const double & b, bool aIsNull, bool bIsNull) const
+	{
+		if(aIsNull)	return b;
+		if(bIsNull)	return a;
+		return (*this)(a, b);
+	}
+private:
+	string mode;
+};
+
+// mtx, mtx.gz (output only), bin (HKDT binary), cbin (compressed edge file) or labels (labeled edge list)
+string FormatOf(const string & filename, const string & given)
+{
+	if(!given.empty())	return given;
+	auto endswith = [&filename](const string & suffix)
+	{
+		return filename.size() >= suffix.size() && filename.compare(filename.size()-suffix.size(), suffix.size(), suffix) == 0;
+	};
+	if(endswith(".mtx.gz"))	return "mtx.gz";
+	if(endswith(".mtx"))	return "mtx";
+	if(endswith(".cbin"))	return "cbin";
+	if(endswith(".bin"))	return "bin";
+	return "labels";
+}
+
+
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+#ifdef _OPENMP
+	int provided;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+#else
+	MPI_Init(&argc, &argv);
+#endif
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+
+	if(argc < 3)
+	{
+		if(myrank == 0)
+		{
+			cout << "Usage: ./GraphConvert <Input> <Output> [options]" << endl;
+			cout << "Formats are deduced from the file names (.mtx, .mtx.gz, .bin, .cbin, anything else is a labeled edge list)" << endl;
+			cout << "  -in <fmt> / -out <fmt> : override them (mtx, mtx.gz, bin, cbin, labels)" << endl;
+			cout << "  -zerobased : Matrix Market input is zero indexed" << endl;
+			cout << "  -dedup <max|min|sum|first> : how duplicates are combined (default: max)" << endl;
+			cout << "  -sym : symmetrize, A := A + A' with duplicates combined as above" << endl;
+			cout << "  -noloops : remove self loops" << endl;
+			cout << "  -relabel : randomly permute the vertices" << endl;
+			cout << "  -nolabels : with a labeled edge list output, write numbers (1-based) instead of the vertex names" << endl;
+			cout << "Labeled edge lists are \"name name [value]\" lines, the vertex names of a labeled input are kept" << endl;
+		}
+		MPI_Finalize();
+		return -1;
+	}
+	{
+		string inname(argv[1]);
+		string outname(argv[2]);
+		string infmt, outfmt, dedup = "max";
+		bool onebased = true, sym = false, noloops = false, relabel = false, nolabels = false;
+		for(int i = 3; i < argc; ++i)
+		{
+			string opt(argv[i]);
+			if(opt == "-in" && i+1 < argc)	infmt = argv[++i];
+			else if(opt == "-out" && i+1 < argc)	outfmt = argv[++i];
+			else if(opt == "-dedup" && i+1 < argc)	dedup = argv[++i];
+			else if(opt == "-zerobased")	onebased = false;
+			else if(opt == "-sym")	sym = true;
+			else if(opt == "-noloops")	noloops = true;
+			else if(opt == "-relabel")	relabel = true;
+			else if(opt == "-nolabels")	nolabels = true;
+			else SpParHelper::Print("Ignoring unknown option " + opt + "\n");
+		}
+		infmt = FormatOf(inname, infmt);
+		outfmt = FormatOf(outname, outfmt);
+		Combine combine(dedup);
+
+		double t0 = MPI_Wtime();
+		shared_ptr<CommGrid> fullWorld(new CommGrid(MPI_COMM_WORLD, 0, 0));
+		PSpMat A(fullWorld);
+		NameVec names(fullWorld);
+		bool labeled = false;
+		if(infmt == "mtx")
+			A.ParallelReadMM(inname, onebased, combine);
+		else if(infmt == "bin")
+			A.ParallelBinaryRead(inname, combine);
+		else if(infmt == "cbin")
+			A.ParallelCompressedRead(inname, combine);
+		else if(infmt == "labels")
+		{
+			names = A.ReadGeneralizedTuples(inname, combine);
+			labeled = true;
+		}
+		else
+		{
+			SpParHelper::Print("Unknown input format " + infmt + "\n");
+			MPI_Abort(MPI_COMM_WORLD, NOFILE);
+		}
+		double t1 = MPI_Wtime();
+		ostringstream outs;
+		outs << "Read " << inname << " (" << infmt << ") in " << t1-t0 << " seconds" << endl;
+		SpParHelper::Print(outs.str());
+		A.PrintInfo();
+
+		if(noloops)
+		{
+			int64_t removed = A.RemoveLoops();
+			outs.str("");
+			outs << "Removed " << removed << " loops" << endl;
+			SpParHelper::Print(outs.str());
+		}
+		if(sym)
+		{
+			if(A.getnrow() != A.getncol())
+			{
+				SpParHelper::Print("Only square matrices can be symmetrized\n");
+				MPI_Abort(MPI_COMM_WORLD, NOTSQUARE);
+			}
+			PSpMat AT = A;
+			AT.Transpose();
+			A = EWiseApply<double, DCCols>(A, AT, combine, [](double, double, bool, bool) { return true; }, true, true, 0.0, 0.0, true, true);
+			SpParHelper::Print("Symmetrized\n");
+		}
+		if(relabel)
+		{
+			if(A.getnrow() != A.getncol())
+			{
+				SpParHelper::Print("Only square matrices can be relabeled\n");
+				MPI_Abort(MPI_COMM_WORLD, NOTSQUARE);
+			}
+			FullyDistVec<int64_t,int64_t> perm(fullWorld);
+			perm.iota(A.getnrow(), 0);
+			perm.RandPerm();
+			A(perm, perm, true);	// in-place permute to save memory, new vertex i is the old perm[i]
+			if(labeled)
+				names = names(perm);
+			SpParHelper::Print("Relabeled\n");
+		}
+		double t2 = MPI_Wtime();
+
+		if(outfmt == "mtx")
+			A.ParallelWriteMM(outname, true);
+		else if(outfmt == "mtx.gz")
+			A.ParallelWriteMM(outname, true, true, 6);
+		else if(outfmt == "bin")
+			A.ParallelBinaryWrite(outname);
+		else if(outfmt == "cbin")
+			A.ParallelCompressedWrite(outname);
+		else if(outfmt == "labels" && labeled && !nolabels)
+			A.ParallelWriteGeneralizedTuples(outname, names);
+		else if(outfmt == "labels")
+			A.ParallelWriteMM(outname, true, false);	// numbers as labels
+		else
+		{
+			SpParHelper::Print("Unknown output format " + outfmt + "\n");
+			MPI_Abort(MPI_COMM_WORLD, NOFILE);
+		}
+		double t3 = MPI_Wtime();
+		outs.str("");
+		outs << "Wrote " << outname << " (" << outfmt << ") in " << t3-t2 << " seconds" << endl;
+		SpParHelper::Print(outs.str());
+		A.PrintInfo();
+	}
+	MPI_Finalize();
+	return 0;
+}
@@ -81,6 +81,39 @@ int main(int argc, char* argv[])
         else{
             if(myrank == 0) fprintf(stderr, "Not correct\n");
         }
+
+        SpTuples<int64_t, double>* Cadaptive_tuples = LocalAdaptiveSpGEMM<PTFF, double>(*Alocal, *Blocal, false, false);
+        SpDCCols < int64_t, double >* Cadaptive = new SpDCCols < int64_t, double >(*Cadaptive_tuples, false);
+        if(*Cadaptive == *CClocal){
+            if(myrank == 0) fprintf(stderr, "Adaptive kernel correct\n");
+        }
+        else{
+            if(myrank == 0) fprintf(stderr, "Adaptive kernel not correct\n");
+        }
+        delete Cadaptive_tuples;
+        delete Cadaptive;
+
+        // scalar linear probing vs bucketed (SIMD) probing in the hash kernel
+        t0 = MPI_Wtime();
+        SpTuples<int64_t, double>* Cscalar_tuples = LocalSpGEMMHash<PTFF, double>(*Alocal, *Blocal, false, false, true, false);
+        t1 = MPI_Wtime();
+        double scalartime = t1 - t0;
+        t0 = MPI_Wtime();
+        SpTuples<int64_t, double>* Csimd_tuples = LocalSpGEMMHash<PTFF, double>(*Alocal, *Blocal, false, false, true, true);
+        t1 = MPI_Wtime();
+        double simdtime = t1 - t0;
+        SpDCCols < int64_t, double >* Cscalar = new SpDCCols < int64_t, double >(*Cscalar_tuples, false);
+        SpDCCols < int64_t, double >* Csimd = new SpDCCols < int64_t, double >(*Csimd_tuples, false);
+        if(*Cscalar == *CClocal && *Csimd == *CClocal){
+            if(myrank == 0) fprintf(stderr, "Hash kernels correct (scalar probing: %lf s, %d-wide bucket probing: %lf s)\n", scalartime, HashBucketWidth<int64_t>(), simdtime);
+        }
+        else{
+            if(myrank == 0) fprintf(stderr, "Hash kernels not correct\n");
+        }
+        delete Cscalar_tuples;
+        delete Csimd_tuples;
+        delete Cscalar;
+        delete Csimd;
         
     }
     MPI_Finalize();
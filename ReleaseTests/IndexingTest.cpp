@@ -31,6 +31,7 @@
 #include <iostream>
 #include <functional>
 #include <algorithm>
+#include <numeric>
 #include <vector>
 #include <sstream>
 #include "CombBLAS/CombBLAS.h"
@@ -124,7 +125,101 @@ int main(int argc, char* argv[])
 		}
 		else
 		{
-			SpParHelper::Print("ERROR in indexing, go fix it!\n");	
+			SpParHelper::Print("ERROR in indexing, go fix it!\n");
+		}
+
+		// batched one-sided access: gather p(p) and scatter the inverse of a random permutation p
+		FullyDistVec<int,int> perm(fullWorld);
+		perm.iota(1000, 0);
+		perm.RandPerm();
+		FullyDistVec<int,int> permsq = perm(perm);
+		FullyDistVec<int,int> inverse(fullWorld, 1000, -1);
+		int perm30 = perm[30];
+		bool batchok = true;
+		{
+			FullyDistVecBatch<int,int> gather(perm);
+			FullyDistVecBatch<int,int> scatter(inverse);
+			vector<int> handles;
+			for(int i=0; i< perm.LocArrSize(); ++i)
+			{
+				handles.push_back(gather.Request(perm.GetLocalElement(i)));
+				gather.Request(perm.GetLocalElement(i));	// repeated requests are free
+				scatter.Set(perm.GetLocalElement(i), i + perm.LengthUntil());
+			}
+			gather.Post();
+			scatter.Flush();	// overlaps with the gets
+			gather.Complete();
+			for(int i=0; i< perm.LocArrSize(); ++i)
+				batchok = batchok && (gather[handles[i]] == permsq.GetLocalElement(i));
+			scatter.Sync();
+
+			gather.Clear();
+			gather.Request(999);	// on a later owner than 30, so a stale get would land after the live one
+			gather.Clear();		// drops the request that was never posted
+			int handle = gather.Request(30);
+			gather.Post();
+			gather.Complete();
+			batchok = batchok && (gather[handle] == perm30) && (gather.getncached() == 1);
+		}
+		FullyDistVec<int,int> identity(fullWorld);
+		identity.iota(1000, 0);
+		int allok, mine = batchok;
+		MPI_Allreduce(&mine, &allok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+		if (allok && inverse(perm) == identity)
+		{
+			SpParHelper::Print("Batched vector access working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in batched vector access, go fix it!\n");
+		}
+
+		// integer keys are radix sorted, the comparison sort of the same keys as doubles must agree (ties are broken by index)
+		FullyDistVec<int,int> keys = perm;
+		keys.Apply([](int val){ return val % 37 - 18; });
+		FullyDistVec<int,double> dkeys(fullWorld);
+		dkeys = keys;
+		FullyDistVec<int,int> sortedkeys = keys;
+		FullyDistVec<int,int> radixperm = sortedkeys.sort();
+		FullyDistVec<int,int> compperm = dkeys.sort();
+		if (radixperm == compperm && keys(radixperm) == sortedkeys)
+		{
+			SpParHelper::Print("Radix sort working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in radix sort, go fix it!\n");
+		}
+		// the sparse sort only orders the nonzeros; check the gathered permutation against the keys directly
+		FullyDistSpVec<int,int> spkeys(keys, [](int val){ return val % 3 != 0; });
+		FullyDistSpVec<int,int> spperm = spkeys.sort();
+		auto allgather = [](const std::vector<int> & loc)
+		{
+			int nprocs, locsize = loc.size();
+			MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+			std::vector<int> sizes(nprocs), displs(nprocs, 0);
+			MPI_Allgather(&locsize, 1, MPI_INT, sizes.data(), 1, MPI_INT, MPI_COMM_WORLD);
+			std::partial_sum(sizes.begin(), sizes.end()-1, displs.begin()+1);
+			std::vector<int> all(displs.back() + sizes.back());
+			MPI_Allgatherv(loc.data(), locsize, MPI_INT, all.data(), sizes.data(), displs.data(), MPI_INT, MPI_COMM_WORLD);
+			return all;
+		};
+		std::vector<int> allkeys = allgather(keys.GetLocVec());
+		std::vector<int> sporder = allgather(spperm.GetLocalNum());
+		bool spok = (spkeys.getnnz() < keys.TotalLength()) && (static_cast<int>(sporder.size()) == spkeys.getnnz());
+		for(size_t i=0; spok && i< sporder.size(); ++i)	// strictly increasing (key, index) pairs over nonzeros only, hence a permutation of them
+		{
+			spok = (allkeys[sporder[i]] % 3 != 0);
+			if(i > 0)
+				spok = spok && (allkeys[sporder[i-1]] < allkeys[sporder[i]] || (allkeys[sporder[i-1]] == allkeys[sporder[i]] && sporder[i-1] < sporder[i]));
+		}
+		if (spok)
+		{
+			SpParHelper::Print("Sparse radix sort working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in sparse radix sort, go fix it!\n");
 		}
 
         	FullyDistVec<int,int> crow(fullWorld);
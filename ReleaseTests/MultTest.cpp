@@ -157,6 +157,42 @@ int main(int argc, char* argv[])
             		SpParHelper::Print("SpMSpV-bucket does not work correctly for general CSC matrices, go fix it!\n");
         	}
 
+		// Direction-optimizing SpMSpV, forced into push (alpha = 0) and pull (alpha = inf) mode, with every third row masked out
+		FullyDistVec<int64_t, int64_t> rowmask(fullWorld);
+		rowmask.iota(A.getnrow(), 0);
+		auto isActive = [](int64_t i){ return i % 3 != 0; };
+		FullyDistSpVec<int64_t, double> spymasked = EWiseApply<double>(spy, rowmask,
+				[](double y, int64_t){ return y; }, [isActive](double, int64_t i){ return isActive(i); }, false, 0.0);
+		SpMSpVDirOpt<int64_t, double, PSpMat<double>::DCCols> pushOpt(A, 0.0);
+		SpMSpVDirOpt<int64_t, double, PSpMat<double>::DCCols> pullOpt(A, std::numeric_limits<double>::infinity());
+		FullyDistSpVec<int64_t, double> spy_push(spx.getcommgrid(), A.getnrow());
+		FullyDistSpVec<int64_t, double> spy_pull(spx.getcommgrid(), A.getnrow());
+		SpMV<PTDOUBLEDOUBLE>(A, spx, spy_push, rowmask, isActive, pushOpt);
+		SpMV<PTDOUBLEDOUBLE>(A, spx, spy_pull, rowmask, isActive, pullOpt);
+		if (spymasked == spy_push && spymasked == spy_pull && pullOpt.pullSteps == 1)
+		{
+			SpParHelper::Print("Direction-optimizing SpMSpV working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in direction-optimizing SpMSpV, go fix it!\n");
+		}
+
+		// SpMSpV with a persistent workspace, called twice so that the second call runs on reused buffers
+		SpMSpVContext<double, double> spmspvctx(A);
+		FullyDistSpVec<int64_t, double> spy_ctx(spx.getcommgrid(), A.getnrow());
+		SpMV<PTDOUBLEDOUBLE>(A, spx, spy_ctx, false, spmspvctx);
+		bool firstcall = (spy == spy_ctx);
+		SpMV<PTDOUBLEDOUBLE>(A, spx, spy_ctx, false, spmspvctx);
+		if (firstcall && spy == spy_ctx)
+		{
+			SpParHelper::Print("SpMSpV with persistent workspace working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in SpMSpV with persistent workspace, go fix it!\n");
+		}
+
 		
 #ifndef NOGEMM
 		C = Mult_AnXBn_Synch<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(A,B);
@@ -179,6 +215,64 @@ int main(int argc, char* argv[])
 		{
 			SpParHelper::Print("ERROR in double buffered multiplication, go fix it!\n");	
 		}
+
+		C = Mult_AnXBn_Pipelined<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(A,B);
+		if (CControl == C)
+		{
+			SpParHelper::Print("Pipelined multiplication working correctly\n");	
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in pipelined multiplication, go fix it!\n");	
+		}
+
+		C = Mult_AnXBn_Synch<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(A,B,false,false,true);
+		if (CControl == C)
+		{
+			SpParHelper::Print("Incrementally merged multiplication working correctly\n");	
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in incrementally merged multiplication, go fix it!\n");	
+		}
+
+		// mask out every other diagonal of the product, then check both mask polarities against the unmasked product
+		PSpMat<double>::MPI_DCCols M = CControl.PruneI([](std::tuple<int64_t,int64_t,double> t){ return (std::get<0>(t) + std::get<1>(t)) % 2 == 0; }, false);
+		M.Apply([](double){ return 1.0; });	// EWiseMult multiplies by the mask values
+		PSpMat<double>::MPI_DCCols CMasked = EWiseMult(CControl, M, false);
+		PSpMat<double>::MPI_DCCols CCompMasked = EWiseMult(CControl, M, true);
+		C = Mult_AnXBn_Masked<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(A,B,M);
+		PSpMat<double>::MPI_DCCols CComp = Mult_AnXBn_Masked<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(A,B,M,true);
+		if (CMasked == C && CCompMasked == CComp)
+		{
+			SpParHelper::Print("Masked multiplication working correctly\n");	
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in masked multiplication, go fix it!\n");	
+		}
+
+		// MCL expansion with prune/select/recovery fused into the merge, against pruning the full product afterwards
+		// on the structure only, so that the products are exact counts and ties do not depend on the summation order
+		PSpMat<double>::MPI_DCCols AOnes(A);
+		PSpMat<double>::MPI_DCCols BOnes(B);
+		AOnes.Apply([](double){ return 1.0; });
+		BOnes.Apply([](double){ return 1.0; });
+		bool fusedok = true;
+		for(int phases = 1; phases <= 2; ++phases)
+		{
+			C = MemEfficientSpGEMM<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(AOnes, BOnes, phases, 2.0, (int64_t) 10, (int64_t) 5, 0.9, 1, 2, 0, false);
+			PSpMat<double>::MPI_DCCols CFused = MemEfficientSpGEMM<PTDOUBLEDOUBLE, double, PSpMat<double>::DCCols >(AOnes, BOnes, phases, 2.0, (int64_t) 10, (int64_t) 5, 0.9, 1, 2, 0, true);
+			fusedok = fusedok && (C == CFused);
+		}
+		if (fusedok)
+		{
+			SpParHelper::Print("Fused prune and select working correctly\n");	
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in fused prune and select, go fix it!\n");	
+		}
 #endif
 		OptBuf<int32_t, int64_t> optbuf;
 		PSpMat<bool>::MPI_DCCols ABool(A);
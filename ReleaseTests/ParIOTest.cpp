@@ -6,6 +6,9 @@
 #include <vector>
 #include <sstream>
 #include "CombBLAS/CombBLAS.h"
+#ifdef COMBBLAS_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace std;
 using namespace combblas;
@@ -90,6 +93,146 @@ int main(int argc, char* argv[])
 			B.ParallelWriteMM("B_Error.mtx", true);
 		}
 
+		A.ParallelBlockWrite("A_Checkpoint.bin");
+		PSpMat<double>::MPI_DCCols C(A.getcommgrid());
+		C.ParallelBlockRead("A_Checkpoint.bin");
+		if (A == C)
+		{
+			SpParHelper::Print("Block checkpoint I/O working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in block checkpoint I/O, go fix it!\n");
+		}
+		PSpMat<double>::MPI_DCCols M(A.getcommgrid());
+		M.ParallelBlockMap("A_Checkpoint.bin");
+		bool mapped = (A == M);
+		M.Prune([](double val) { return val > 1.0; });	// in-place update of the mapped arrays
+		C.Prune([](double val) { return val > 1.0; });
+		if (mapped && C == M)
+		{
+			SpParHelper::Print("Memory mapped checkpoint loading working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in memory mapped checkpoint loading, go fix it!\n");
+		}
+		A.ParallelCompressedWrite("A_Compressed.bin");
+		PSpMat<double>::MPI_DCCols E(A.getcommgrid());
+		E.ReadDistribute("A_Compressed.bin", 0);
+		if (A == E)
+		{
+			SpParHelper::Print("Compressed edge file I/O working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in compressed edge file I/O, go fix it!\n");
+		}
+		A.ParallelWriteMM("A_Written.mtx", true);
+		PSpMat<double>::MPI_DCCols F(A.getcommgrid());
+		F.ParallelReadMM("A_Written.mtx", true, maximum<double>());
+		if (A == F)
+		{
+			SpParHelper::Print("Parallel Matrix Market writer working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in parallel Matrix Market writer, go fix it!\n");
+		}
+#ifdef COMBBLAS_ZLIB
+		A.ParallelWriteMM("A_Written.mtx.gz", true, true, 6);
+		if(myrank == 0)	// the members written by every thread of every rank have to decode as a single stream
+		{
+			gzFile gzin = gzopen("A_Written.mtx.gz", "rb");
+			ofstream gunzipped("A_Gunzipped.mtx", ios::binary);
+			char gzbuf[1 << 16];
+			int nread;
+			while((nread = gzread(gzin, gzbuf, sizeof(gzbuf))) > 0)
+				gunzipped.write(gzbuf, nread);
+			gzclose(gzin);
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+		PSpMat<double>::MPI_DCCols Z(A.getcommgrid());
+		Z.ParallelReadMM("A_Gunzipped.mtx", true, maximum<double>());
+		if (A == Z)
+		{
+			SpParHelper::Print("Compressed Matrix Market writer working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in compressed Matrix Market writer, go fix it!\n");
+		}
+#endif
+		A.ParallelBinaryWrite("A_Binary.bin");
+		PSpMat<double>::MPI_DCCols G(A.getcommgrid());
+		G.ParallelBinaryRead("A_Binary.bin", maximum<double>());
+		if (A == G)
+		{
+			SpParHelper::Print("Parallel binary I/O working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in parallel binary I/O, go fix it!\n");
+		}
+		B.ParallelWriteGeneralizedTuples("B_Labeled.txt", perm);
+		PSpMat<double>::MPI_DCCols H(B.getcommgrid());
+		H.ReadGeneralizedTuples("B_Labeled.txt", maximum<double>());
+		if (B == H)
+		{
+			SpParHelper::Print("Labeled edge list writer working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in labeled edge list writer, go fix it!\n");
+		}
+		// CRLF line ends, comment and blank lines, tabs, a hex float, and no line break at the end of the file
+		if(myrank == 0)
+		{
+			ofstream messy("Messy.mtx", ios::binary);
+			messy << "%%MatrixMarket matrix coordinate real general\r\n% comment\r\n5 4 6\r\n1 1 1.5\r\n%comment\r\n\r\n";
+			messy << "2\t3\t0x1p3\r\n3 2 -2.25e1\r\n 4 4 1e-3\r\n5 1 .5\r\n5 4 7";
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+		PSpMat<double>::MPI_DCCols Messy(A.getcommgrid());
+		Messy.ParallelReadMM("Messy.mtx", true, maximum<double>());
+		int64_t messyrows[] = {0, 1, 2, 3, 4, 4};
+		int64_t messycols[] = {0, 2, 1, 3, 0, 3};
+		double messyvals[] = {1.5, 8.0, -22.5, 0.001, 0.5, 7.0};
+		FullyDistVec<int64_t,int64_t> mrows(A.getcommgrid(), 6, 0);
+		FullyDistVec<int64_t,int64_t> mcols(A.getcommgrid(), 6, 0);
+		FullyDistVec<int64_t,double> mvals(A.getcommgrid(), 6, 0.0);
+		for(int64_t i = 0; i < 6; ++i)
+		{
+			mrows.SetElement(i, messyrows[i]);
+			mcols.SetElement(i, messycols[i]);
+			mvals.SetElement(i, messyvals[i]);
+		}
+		PSpMat<double>::MPI_DCCols MessyControl(5, 4, mrows, mcols, mvals);
+		if (Messy == MessyControl)
+		{
+			SpParHelper::Print("Matrix Market tokenizer working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in Matrix Market tokenizer, go fix it!\n");
+		}
+		if(nprocs > 1)	// restart from the same checkpoint on a grid of a different shape
+		{
+			shared_ptr<CommGrid> selfGrid(new CommGrid(MPI_COMM_SELF, 1, 1));
+			PSpMat<double>::MPI_DCCols D(selfGrid);
+			D.ParallelBlockRead("A_Checkpoint.bin");
+			double sumA = A.Reduce(Column, plus<double>(), 0.0).Reduce(plus<double>(), 0.0);
+			double sumD = D.Reduce(Column, plus<double>(), 0.0).Reduce(plus<double>(), 0.0);
+			if (D.getnnz() == A.getnnz() && D.getnrow() == A.getnrow() && D.getncol() == A.getncol() && fabs(sumA - sumD) < 1e-8)
+			{
+				SpParHelper::Print("Grid reshaping restart working correctly\n");
+			}
+			else
+			{
+				SpParHelper::Print("ERROR in grid reshaping restart, go fix it!\n");
+			}
+		}
+
 		perm.ParallelWrite("PermutationVec.mtx", 1, StdArrayReadSaveHandler(), true);
 	}
 	MPI_Finalize();
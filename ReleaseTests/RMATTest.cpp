@@ -0,0 +1,111 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.5 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <mpi.h>
+#include <sys/time.h> 
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpParMat < int64_t, double, SpDCCols<int64_t,double> > PARDBMAT;
+
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+
+	if(argc < 3)
+	{
+		if(myrank == 0)
+		{
+			cout << "Usage: ./RMATTest <Scale> <Edgefactor>" << endl;
+			cout << "Generates the same R-MAT matrix on one processor and on different grids of all processors" << endl;
+		}
+		MPI_Finalize(); 
+		return -1;
+	}				
+	{
+		int scale = atoi(argv[1]);
+		int edgefactor = atoi(argv[2]);
+		double initiator[4] = {.57, .19, .19, .05};
+		shared_ptr<CommGrid> fullWorld(new CommGrid(MPI_COMM_WORLD, 0, 0));
+
+		PARDBMAT G(fullWorld);
+		G.GenerateRMAT(scale, edgefactor, initiator, 1, false);	// keeps self-loops, duplicates are summed
+
+		// every generated edge is counted once in the values
+		FullyDistVec<int64_t,double> colsums = G.Reduce(Column, plus<double>(), 0.0);
+		double edges = colsums.Reduce(plus<double>(), 0.0);
+		int64_t nverts = (int64_t) 1 << scale;
+		if (G.getnrow() == nverts && G.getncol() == nverts && edges == (double) edgefactor * nverts && G.getnnz() <= edgefactor * nverts)
+		{
+			SpParHelper::Print("R-MAT edge count working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in R-MAT edge count, go fix it!\n");
+		}
+
+		// a single processor and a 1 x p grid have to generate exactly the matrix of the square grid
+		if(myrank == 0)
+		{
+			shared_ptr<CommGrid> selfWorld(new CommGrid(MPI_COMM_SELF, 1, 1));
+			PARDBMAT S(selfWorld);
+			S.GenerateRMAT(scale, edgefactor, initiator, 1, false);
+			S.ParallelWriteMM("RMAT_Serial.mtx", true);
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+		PARDBMAT SControl(fullWorld);
+		SControl.ParallelReadMM("RMAT_Serial.mtx", true, maximum<double>());
+
+		shared_ptr<CommGrid> rowWorld(new CommGrid(MPI_COMM_WORLD, 1, nprocs));
+		PARDBMAT R(rowWorld);
+		R.GenerateRMAT(scale, edgefactor, initiator, 1, false);
+		R.ParallelWriteMM("RMAT_Row.mtx", true);
+		PARDBMAT RControl(fullWorld);
+		RControl.ParallelReadMM("RMAT_Row.mtx", true, maximum<double>());
+		if (G == SControl && G == RControl)
+		{
+			SpParHelper::Print("R-MAT grid invariance working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in R-MAT grid invariance, go fix it!\n");
+		}
+	}
+	MPI_Finalize();
+	return 0;
+}
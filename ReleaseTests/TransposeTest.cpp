@@ -80,7 +80,52 @@ int main(int argc, char* argv[])
 		}
 		else
 		{
-			SpParHelper::Print("ERROR in transpose, go fix it!\n");	
+			SpParHelper::Print("ERROR in transpose, go fix it!\n");
+		}
+
+		// the cached view has to follow the changes of A, and Transpose() swaps it in
+		bool viewok = (A.TransposeView() == ATControl);
+		PARBOOLMAT B = A;
+		A.Prune([](bool val) { return val; });	// empties A
+		viewok = viewok && (A.TransposeView().getnnz() == 0);
+		A = B;
+		viewok = viewok && (A.TransposeView() == ATControl);
+		A.Transpose();
+		viewok = viewok && (A == ATControl) && (A.TransposeView() == B);
+		if (viewok)
+		{
+			SpParHelper::Print("Cached transpose view working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in cached transpose view, go fix it!\n");
+		}
+
+		// an operand cleared by a multiplication is freed like FreeMemory(), so its version moves on and its views are dropped
+		typedef PlusTimesSRing<bool,bool> PTBOOLBOOL;
+		PARBOOLMAT Control = Mult_AnXBn_Synch<PTBOOLBOOL, bool, SpDCCols<int,bool> >(A, B);
+		bool clearok = true;
+		for(int variant = 0; variant < 2; ++variant)
+		{
+			PARBOOLMAT C = A;
+			PARBOOLMAT D = B;
+			C.TransposeView();
+			D.TransposeView();
+			uint64_t cversion = C.getversion();
+			uint64_t dversion = D.getversion();
+			PARBOOLMAT CD = (variant == 0) ? Mult_AnXBn_Synch<PTBOOLBOOL, bool, SpDCCols<int,bool> >(C, D, true, true)
+						       : Mult_AnXBn_DoubleBuff<PTBOOLBOOL, bool, SpDCCols<int,bool> >(C, D, true, true);
+			clearok = clearok && (CD == Control) && (C.getversion() != cversion) && (D.getversion() != dversion);
+			C = B;
+			clearok = clearok && (C.TransposeView() == A);
+		}
+		if (clearok)
+		{
+			SpParHelper::Print("Clearing multiplication operands working correctly\n");
+		}
+		else
+		{
+			SpParHelper::Print("ERROR in clearing multiplication operands, go fix it!\n");
 		}
 	}
 	MPI_Finalize();
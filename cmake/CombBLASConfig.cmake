@@ -1,4 +1,5 @@
 find_package(MPI REQUIRED QUIET)
 find_package(OpenMP QUIET)
+find_package(ZLIB QUIET)
 
 include("${CMAKE_CURRENT_LIST_DIR}/CombBLASTargets.cmake")
\ No newline at end of file
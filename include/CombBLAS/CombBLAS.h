@@ -125,8 +125,10 @@ class EWiseExtToPlainAdapter
 #include "SpParMat3D.h"
 #include "FullyDistVec.h"
 #include "FullyDistSpVec.h"
+#include "FullyDistVecBatch.h"
 #include "VecIterator.h"
 #include "PreAllocatedSPA.h"
+#include "SpMSpVContext.h"
 #include "ParFriends.h"
 #include "BlockSpGEMM.h"
 #include "BFSFriends.h"
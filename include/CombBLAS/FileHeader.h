@@ -48,6 +48,53 @@ struct HeaderInfo
 	uint64_t nnz;
 };
 	
+//! Header of the block checkpoint format written by SpParMat::ParallelBlockWrite
+struct BlockHeaderInfo
+{
+	char magic[8];		// "CBDC" padded with zeros, so that everything after it stays 8-byte aligned
+	uint64_t version;
+	uint64_t idxsize;	// sizeof(IT)
+	uint64_t objsize;	// sizeof(NT)
+
+	uint64_t m;
+	uint64_t n;
+	uint64_t nnz;
+	uint64_t gridrows;	// shape of the processor grid the blocks were saved from
+	uint64_t gridcols;
+};
+
+//! Directory entry of one local block of a block checkpoint
+struct BlockEntryInfo
+{
+	uint64_t m;		// local dimensions
+	uint64_t n;
+	uint64_t nnz;
+	uint64_t nzc;		// number of nonzero columns (length of jc)
+	uint64_t offset;	// location of jc[nzc] cp[nzc+1] ir[nnz] numx[nnz] in the file
+	uint64_t bytes;
+};
+
+//! Follows the HKDT header of compressed (format 2) edge files written by SpParMat::ParallelCompressedWrite
+struct CompressedHeaderInfo
+{
+	uint64_t nblocks;
+	uint64_t valuecodec;	// 0: no values stored (pattern), 1: raw values of objsize bytes
+};
+
+/**
+ * Block index entry of a compressed edge file
+ * A block holds a set of columns, each encoded as varint(column - previous column) varint(count) followed by
+ * count varint row indices (first absolute, then deltas from the previous row), all after a uint64_t length of that
+ * index part; the values (if any) follow the index part in the same order
+ */
+struct CompressedBlockInfo
+{
+	uint64_t firstcol;	// the first column delta of the block is relative to this
+	uint64_t nnz;
+	uint64_t offset;	// location of the block in the file
+	uint64_t bytes;
+};
+
 // cout's are OK because ParseHeader is run by a single processor only
 inline HeaderInfo ParseHeader(const std::string & inputname, FILE * & f, int & seeklength)
 {
@@ -281,11 +281,11 @@ FullyDistSpVec<IT,NT>::FullyDistSpVec (IT globallen, const FullyDistVec<IT,IT> &
     // ----- Send and receive indices and values --------
 
     NT * recvdatbuf = new NT[totrecv];
-    MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+    SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
     delete [] indbuf;
 
 
@@ -377,7 +377,7 @@ FullyDistVec<IT,NT> FullyDistSpVec<IT,NT>::FindVals(_Predicate pred) const
     std::vector<NT> recvbuf(totrecv);
 
     // data is already in the right order in found.arr
-    MPI_Alltoallv(found.arr.data(), sendcnt, sdispls, MPIType<NT>(), recvbuf.data(), recvcnt, rdispls, MPIType<NT>(), World);
+    SpParHelper::Alltoallv(found.arr.data(), sendcnt, sdispls, MPIType<NT>(), recvbuf.data(), recvcnt, rdispls, MPIType<NT>(), World);
     found.arr.swap(recvbuf);
     delete [] dist;
     DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
@@ -442,7 +442,7 @@ FullyDistVec<IT,IT> FullyDistSpVec<IT,NT>::FindInds(_Predicate pred) const
     std::vector<IT> recvbuf(totrecv);
 
     // data is already in the right order in found.arr
-    MPI_Alltoallv(found.arr.data(), sendcnt, sdispls, MPIType<IT>(), recvbuf.data(), recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(found.arr.data(), sendcnt, sdispls, MPIType<IT>(), recvbuf.data(), recvcnt, rdispls, MPIType<IT>(), World);
     found.arr.swap(recvbuf);
     delete [] dist;
     DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
@@ -620,7 +620,7 @@ FullyDistVec<IT,NT> FullyDistSpVec<IT,NT>::operator() (const FullyDistVec<IT,IT>
     std::copy(data_req[i].begin(), data_req[i].end(), sendbuf+sdispls[i]);
 		std::vector<IT>().swap(data_req[i]);
 	}
-	MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<IT>(), recvbuf, recvcnt, rdispls, MPIType<IT>(), World);  // request data
+	SpParHelper::Alltoallv(sendbuf, sendcnt, sdispls, MPIType<IT>(), recvbuf, recvcnt, rdispls, MPIType<IT>(), World);  // request data
 
 	// We will return the requested data,
 	// our return can be at most as big as the request
@@ -650,8 +650,8 @@ FullyDistVec<IT,NT> FullyDistSpVec<IT,NT>::operator() (const FullyDistVec<IT,IT>
 	NT * databuf = new NT[ri.LocArrSize()];
 
 	MPI_Alltoall(recvcnt, 1, MPI_INT, sendcnt, 1, MPI_INT, World);	// share the response counts, overriding request counts
-	MPI_Alltoallv(indsback, recvcnt, rdispls, MPIType<IT>(), sendbuf, sendcnt, sdispls, MPIType<IT>(), World);  // send indices
-	MPI_Alltoallv(databack, recvcnt, rdispls, MPIType<NT>(), databuf, sendcnt, sdispls, MPIType<NT>(), World);  // send data
+	SpParHelper::Alltoallv(indsback, recvcnt, rdispls, MPIType<IT>(), sendbuf, sendcnt, sdispls, MPIType<IT>(), World);  // send indices
+	SpParHelper::Alltoallv(databack, recvcnt, rdispls, MPIType<NT>(), databuf, sendcnt, sdispls, MPIType<NT>(), World);  // send data
 	DeleteAll(rdispls, recvcnt, indsback, databack);
 
 	// Now create the output from databuf (holds numerical values) and sendbuf (holds indices)
@@ -772,6 +772,21 @@ FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 	FullyDistSpVec<IT,IT> temp(commGrid);
     if(getnnz()==0) return temp;
 	IT nnz = getlocnnz();
+    if constexpr (std::is_integral<NT>::value && !std::is_same<NT,bool>::value)	// radix sort, ties broken by index as below
+    {
+        std::vector<NT> keys(num);
+        std::vector<IT> perm(nnz);
+        IT until = LengthUntil();
+        for(IT i=0; i< nnz; ++i)
+            perm[i] = ind[i] + until;
+        SpParHelper::RadixPSort(keys, perm, World);
+        temp.num.swap(perm);
+        temp.ind.resize(nnz);
+        for(IT i=0; i< nnz; ++i)
+            temp.ind[i] = i; // we are not using this information at this moment
+        temp.glen = glen;
+        return temp;
+    }
 	std::pair<NT,IT> * vecpair = new std::pair<NT,IT>[nnz];
 
 
@@ -938,11 +953,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT, NT>::UniqAll2All(_BinaryOperation __bin
 	}
     IT totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));
 	NT * recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
     delete [] indbuf;
 
     std::vector< std::pair<NT,IT> > tosort;   // in fact, tomerge would be a better name but it is unlikely to be faster
@@ -993,11 +1008,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT, NT>::UniqAll2All(_BinaryOperation __bin
     totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));   // update value
 
     recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] datbuf;
 
     recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
     delete [] indbuf;
 
     FullyDistSpVec<IT,NT> Indexed(commGrid, glen);	// length(Indexed) = length(glen) = length(*this)
@@ -1179,7 +1194,7 @@ void FullyDistSpVec<IT,NT>::SparseCommon(std::vector< std::vector < std::pair<IT
 	MPI_Type_commit(&MPI_pair);
 
 	std::pair<IT,NT> * recvdata = new std::pair<IT,NT>[totrecv];
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPI_pair, recvdata, recvcnt, rdispls, MPI_pair, commGrid->GetWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPI_pair, recvdata, recvcnt, rdispls, MPI_pair, commGrid->GetWorld());
 
 	DeleteAll(senddata, sendcnt, recvcnt, sdispls, rdispls);
 	MPI_Type_free(&MPI_pair);
@@ -1850,11 +1865,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 	}
     IT totrecv = accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));
 	NT * recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
     delete [] indbuf;
 
 
@@ -1968,11 +1983,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 
     IT totrecv = rdispls[nprocs];
 	NT * recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
     delete [] indbuf;
 
 
@@ -2110,11 +2125,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen, _BinaryOperat
 
     IT totrecv = rdispls[nprocs];
     NT * recvdatbuf = new NT[totrecv];
-    MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+    SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
     delete [] indbuf;
 
 
@@ -55,6 +55,12 @@ class FullyDistVec;
 template <class IU, class NU>
 class SparseVectorLocalIterator;
 
+template <class IU, class NU, class UDER>
+class SpMSpVDirOpt;
+
+template <class IVT, class OVT>
+class SpMSpVContext;
+
 /** 
   * A sparse vector of length n (with nnz <= n of them being nonzeros) is distributed to 
   * "all the processors" in a way that "respects ordering" of the nonzero indices
@@ -77,6 +83,7 @@ public:
 	explicit FullyDistSpVec ( IT glen );
 	FullyDistSpVec ( std::shared_ptr<CommGrid> grid);
 	FullyDistSpVec ( std::shared_ptr<CommGrid> grid, IT glen);
+	FullyDistSpVec ( const FullyDistSpVec<IT,NT> & rhs ) = default;	// declared because operator= is user provided
 
     template <typename _UnaryOperation>
     FullyDistSpVec (const FullyDistVec<IT,NT> & rhs, _UnaryOperation unop);
@@ -360,6 +367,14 @@ private:
     template <typename SR, typename IVT, typename OVT, typename IU, typename NUM, typename UDER>
     friend void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, FullyDistSpVec<IU,OVT> & y,bool indexisvalue, OptBuf<int32_t, OVT > & optbuf, PreAllocatedSPA<OVT> & SPA);
 
+	template <typename SR, typename IVT, typename OVT, typename IU, typename NUM, typename UDER>
+	friend void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, FullyDistSpVec<IU,OVT> & y,
+			bool indexisvalue, SpMSpVContext<IVT,OVT> & ctx);
+
+	template <typename SR, typename IVT, typename OVT, typename IU, typename NUM, typename UDER, typename MT, typename _UnaryPredicate>
+	friend void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, FullyDistSpVec<IU,OVT> & y,
+			const FullyDistVec<IU,MT> & mask, _UnaryPredicate isActive, SpMSpVDirOpt<IU,NUM,UDER> & dirOpt);
+
 	template <typename IU, typename NU1, typename NU2>
 	friend FullyDistSpVec<IU,typename promote_trait<NU1,NU2>::T_promote> 
 	EWiseMult (const FullyDistSpVec<IU,NU1> & V, const FullyDistVec<IU,NU2> & W , bool exclude, NU2 zero);
@@ -127,7 +127,7 @@ FullyDistVec<IT, NT>::FullyDistVec ( const std::vector<NT> & fillarr, std::share
 	arr.resize(totrecv);
 		
 	// data is already in the right order in found.arr
-	MPI_Alltoallv(fillarr.data(), sendcnt, sdispls, MPIType<NT>(), arr.data(), recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(fillarr.data(), sendcnt, sdispls, MPIType<NT>(), arr.data(), recvcnt, rdispls, MPIType<NT>(), World);
 	DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
 	delete [] sizes;	
 }
@@ -442,7 +442,7 @@ FullyDistVec<IT,IT> FullyDistVec<IT,NT>::FindInds(_Predicate pred) const
 	std::vector<IT> recvbuf(totrecv);
 			
 	// data is already in the right order in found.arr
-	MPI_Alltoallv(&(found.arr[0]), sendcnt, sdispls, MPIType<IT>(), &(recvbuf[0]), recvcnt, rdispls, MPIType<IT>(), World);
+	SpParHelper::Alltoallv(&(found.arr[0]), sendcnt, sdispls, MPIType<IT>(), &(recvbuf[0]), recvcnt, rdispls, MPIType<IT>(), World);
 	found.arr.swap(recvbuf);
 	delete [] dist;
 	DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
@@ -576,6 +576,50 @@ NT FullyDistVec<IT,NT>::GetElement (IT indx) const
 	return ret;
 }
 
+/**
+ * Collective: every processor fetches the elements with global indices [begin,end) into range (in order)
+ * Since each processor owns a contiguous piece of the vector, a request is a single (begin,end) pair per owner
+ * and the elements come back with one all-to-all, no matter how long the ranges are
+ */
+template <class IT, class NT>
+void FullyDistVec<IT,NT>::GetRange (IT begin, IT end, std::vector<NT> & range) const
+{
+	MPI_Comm World = commGrid->GetWorld();
+	int nprocs = commGrid->GetSize();
+	begin = std::max(begin, static_cast<IT>(0));
+	end = std::max(begin, std::min(end, glen));
+
+	std::vector<IT> starts(nprocs+1);
+	IT mystart = LengthUntil();
+	MPI_Allgather(&mystart, 1, MPIType<IT>(), starts.data(), 1, MPIType<IT>(), World);
+	starts[nprocs] = glen;
+
+	std::vector<IT> requests(2*nprocs);	// [lo,hi) asked from each owner
+	std::vector<int> recvcnt(nprocs, 0);
+	for(int i=0; i< nprocs; ++i)
+	{
+		requests[2*i] = std::max(begin, starts[i]);
+		requests[2*i+1] = std::max(requests[2*i], std::min(end, starts[i+1]));
+		recvcnt[i] = static_cast<int>(requests[2*i+1] - requests[2*i]);
+	}
+	std::vector<IT> asked(2*nprocs);
+	MPI_Alltoall(requests.data(), 2, MPIType<IT>(), asked.data(), 2, MPIType<IT>(), World);
+
+	std::vector<int> sendcnt(nprocs), sdispls(nprocs+1, 0), rdispls(nprocs+1, 0);
+	for(int i=0; i< nprocs; ++i)
+	{
+		sendcnt[i] = static_cast<int>(asked[2*i+1] - asked[2*i]);
+		sdispls[i+1] = sdispls[i] + sendcnt[i];
+		rdispls[i+1] = rdispls[i] + recvcnt[i];
+	}
+	std::vector<NT> sendbuf(sdispls[nprocs]);
+	for(int i=0; i< nprocs; ++i)
+		std::copy(arr.begin() + (asked[2*i] - mystart), arr.begin() + (asked[2*i+1] - mystart), sendbuf.begin() + sdispls[i]);
+
+	range.resize(end - begin);
+	SpParHelper::Alltoallv(sendbuf.data(), sendcnt.data(), sdispls.data(), MPIType<NT>(), range.data(), recvcnt.data(), rdispls.data(), MPIType<NT>(), World);
+}
+
 // Write to file using MPI-2
 template <class IT, class NT>
 void FullyDistVec<IT,NT>::DebugPrint()
@@ -749,6 +793,17 @@ FullyDistVec<IT, IT> FullyDistVec<IT, NT>::sort()
 	MPI_Comm World = commGrid->GetWorld();
 	FullyDistVec<IT,IT> temp(commGrid);
 	IT nnz = LocArrSize(); 
+	if constexpr (std::is_integral<NT>::value && !std::is_same<NT,bool>::value)	// radix sort, ties broken by index as below
+	{
+		std::vector<IT> narr(nnz);
+		IT sizeuntil = LengthUntil();
+		for(IT i=0; i< nnz; ++i)
+			narr[i] = i + sizeuntil;
+		SpParHelper::RadixPSort(arr, narr, World);
+		temp.glen = glen;
+		temp.arr.swap(narr);
+		return temp;
+	}
 	std::pair<NT,IT> * vecpair = new std::pair<NT,IT>[nnz];
 	int nprocs = commGrid->GetSize();
 	int rank = commGrid->GetRank();
@@ -854,7 +909,7 @@ void FullyDistVec<IT,NT>::RandPerm(uint64_t seed)
         std::vector<NT>().swap(data_send[i]);	// free memory
     }
 	NT * recvbuf = new NT[totrecv];
-    MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<NT>(), recvbuf, recvcnt, rdispls, MPIType<NT>(), World);
+    SpParHelper::Alltoallv(sendbuf, sendcnt, sdispls, MPIType<NT>(), recvbuf, recvcnt, rdispls, MPIType<NT>(), World);
 	//std::random_shuffle(recvbuf, recvbuf+ totrecv);
     std::default_random_engine gen(seed);
     std::shuffle(recvbuf, recvbuf+ totrecv,gen); // locally shuffle data
@@ -899,7 +954,7 @@ void FullyDistVec<IT,NT>::RandPerm(uint64_t seed)
         std::vector<NT>().swap(data_send[i]);	// free memory
     }
     // re-use the send buffer as receive buffer of second stage
-    MPI_Alltoallv(recvbuf, sendcnt, sdispls, MPIType<NT>(), sendbuf, recvcnt, rdispls, MPIType<NT>(), World);
+    SpParHelper::Alltoallv(recvbuf, sendcnt, sdispls, MPIType<NT>(), sendbuf, recvcnt, rdispls, MPIType<NT>(), World);
     delete [] recvbuf;
     IT * newinds = new IT[totalsend];
     for(int i=0; i<nprocs; ++i)
@@ -908,7 +963,7 @@ void FullyDistVec<IT,NT>::RandPerm(uint64_t seed)
         std::vector<IT>().swap(locs_send[i]);	// free memory
     }
     IT * indsbuf = new IT[size];
-	MPI_Alltoallv(newinds, sendcnt, sdispls, MPIType<IT>(), indsbuf, recvcnt, rdispls, MPIType<IT>(), World);
+	SpParHelper::Alltoallv(newinds, sendcnt, sdispls, MPIType<IT>(), indsbuf, recvcnt, rdispls, MPIType<IT>(), World);
     DeleteAll(newinds, sendcnt, sdispls, rdispls, recvcnt);
     arr.resize(size);
     for(IT i=0; i<size; ++i)
@@ -984,7 +1039,7 @@ FullyDistVec<IT,NT> FullyDistVec<IT,NT>::operator() (const FullyDistVec<IT,IT> &
 	}
 
 	IT * recvbuf = new IT[totrecv];
-	MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<IT>(), recvbuf, recvcnt, rdispls, MPIType<IT>(), World);  // request data
+	SpParHelper::Alltoallv(sendbuf, sendcnt, sdispls, MPIType<IT>(), recvbuf, recvcnt, rdispls, MPIType<IT>(), World);  // request data
 	delete [] sendbuf;
 		
 	// We will return the requested data,
@@ -1003,7 +1058,7 @@ FullyDistVec<IT,NT> FullyDistVec<IT,NT>::operator() (const FullyDistVec<IT,IT> &
 	NT * databuf = new NT[riloclen];
 
 	// the response counts are the same as the request counts 
-	MPI_Alltoallv(databack, recvcnt, rdispls, MPIType<NT>(), databuf, sendcnt, sdispls, MPIType<NT>(), World);  // send data
+	SpParHelper::Alltoallv(databack, recvcnt, rdispls, MPIType<NT>(), databuf, sendcnt, sdispls, MPIType<NT>(), World);  // send data
 	DeleteAll(rdispls, recvcnt, databack);
 
 	// Now create the output from databuf
@@ -1118,14 +1173,27 @@ void FullyDistVec<IT,NT>::GSet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOpe
     //MPI_Win_fence(0, win);
     for(int i=0; i<nprocs; ++i)
     {
-        if(i!=myrank)
+        if(i!=myrank && datsent[i].size() > 0)
         {
-            MPI_Win_lock(MPI_LOCK_SHARED,i,MPI_MODE_NOCHECK,win);
-            for(int j = 0; j < datsent[i].size(); ++j)
+            // one put per target, with repeated indices sent once (the last value wins, as with the sequential puts)
+            std::unordered_map<IT, IT> lastpos;
+            for(IT j = 0; j < datsent[i].size(); ++j)
+                lastpos[indsent[i][j]] = j;
+            std::vector<IT> uniqinds;
+            std::vector<NT> uniqvals;
+            for(IT j = 0; j < datsent[i].size(); ++j)
             {
-                MPI_Put(&datsent[i][j], 1, MPIType<NT>(), i, indsent[i][j], 1, MPIType<NT>(), win);
+                if(lastpos[indsent[i][j]] == j)
+                {
+                    uniqinds.push_back(indsent[i][j]);
+                    uniqvals.push_back(datsent[i][j]);
+                }
             }
+            MPI_Datatype targettype = FullyDistVecBatch<IT,NT>::ScatteredType(uniqinds.data(), static_cast<int>(uniqinds.size()));
+            MPI_Win_lock(MPI_LOCK_SHARED,i,MPI_MODE_NOCHECK,win);
+            MPI_Put(uniqvals.data(), static_cast<int>(uniqvals.size()), MPIType<NT>(), i, 0, 1, targettype, win);
             MPI_Win_unlock(i, win);
+            MPI_Type_free(&targettype);
         }
     }
     //MPI_Win_fence(0, win);
@@ -1149,14 +1217,6 @@ template <class NT1, typename _BinaryOperationIdx>
         MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
     }
     
-    MPI_Comm World = commGrid->GetWorld();
-    int nprocs = commGrid->GetSize();
-    int myrank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
-    
-    
-    std::vector< std::vector< NT > > spIdx(nprocs);
-    std::vector< std::vector< IT > > indsent(nprocs);
     IT lengthUntil = spVec.LengthUntil();
     IT spVecSize = spVec.getlocnnz();
     
@@ -1164,47 +1224,30 @@ template <class NT1, typename _BinaryOperationIdx>
     res.ind.resize(spVecSize);
     res.num.resize(spVecSize);
     
-    
+    FullyDistVecBatch<IT,NT> batch(*this);	// one get per owner, repeated indices are fetched once
+    std::vector<IT> handles(spVecSize);
+    std::vector<bool> requested(spVecSize, false);
     for(IT k=0; k < spVecSize; ++k)
     {
-        IT locind;
         // get global index of the dense vector from the value. Most often a select operator.
         // If the first operand is selected, then invert; otherwise, EwiseApply.
         IT globind = __binopIdx(spVec.num[k], spVec.ind[k] + lengthUntil);
-        int owner = Owner(globind, locind); // get local index
-        //NT val = __binopVal(spVec.num[k], spVec.ind[k] + lengthUntil);
         if(globind < glen) // prevent index greater than size of the composed vector
         {
-            spIdx[owner].push_back(k); // position of spVec
-            indsent[owner].push_back(locind);   // so that we don't need no correction at the recipient
+            handles[k] = batch.Request(globind);
+            requested[k] = true;
         }
         else
             res.num[k] = nullValue;
         res.ind[k] = spVec.ind[k];
     }
-    
-    
-    for(int j = 0; j < indsent[myrank].size(); ++j)	// directly get local entries
-    {
-        res.num[spIdx[myrank][j]] = arr[indsent[myrank][j]];
-    }
-    
-    
-    MPI_Win win;
-    MPI_Win_create(&arr[0], LocArrSize() * sizeof(NT), sizeof(NT), MPI_INFO_NULL, World, &win);
-    for(int i=0; i<nprocs; ++i)
+    batch.Post();
+    batch.Complete();
+    for(IT k=0; k < spVecSize; ++k)
     {
-        if(i!=myrank)
-        {
-            MPI_Win_lock(MPI_LOCK_SHARED,i,MPI_MODE_NOCHECK,win);
-            for(int j = 0; j < indsent[i].size(); ++j)
-            {
-                MPI_Get(&res.num[spIdx[i][j]], 1, MPIType<NT>(), i, indsent[i][j], 1, MPIType<NT>(), win);
-            }
-            MPI_Win_unlock(i, win);
-        }
+        if(requested[k])
+            res.num[k] = batch[handles[k]];
     }
-    MPI_Win_free(&win);
     
     return res;
 }
@@ -55,6 +55,9 @@ class DistEdgeList;
 template <class IU, class NU>
 class DenseVectorLocalIterator;
 
+template <class IT, class NT>
+class FullyDistVecBatch;
+
 // ABAB: As opposed to SpParMat, IT here is used to encode global size and global indices;
 // therefore it can not be 32-bits, in general.
 template <class IT, class NT>
@@ -65,6 +68,7 @@ public:
 	FullyDistVec ( IT globallen, NT initval);
 	FullyDistVec ( std::shared_ptr<CommGrid> grid);
 	FullyDistVec ( std::shared_ptr<CommGrid> grid, IT globallen, NT initval);
+	FullyDistVec ( const FullyDistVec<IT, NT> & rhs ) = default;	// declared because operator= is user provided
 	FullyDistVec ( const FullyDistSpVec<IT, NT> & rhs ); // Sparse -> Dense conversion constructor
     FullyDistVec ( const std::vector<NT> & fillarr, std::shared_ptr<CommGrid> grid ); // initialize a FullyDistVec with a vector of length n/p from each processor
 
@@ -144,6 +148,7 @@ public:
 	void SetElement (IT indx, NT numx);	// element-wise assignment
 	void SetLocalElement(IT index, NT value) {  arr[index] = value; }; // no checks, local index
 	NT   GetElement (IT indx) const;	// element-wise fetch
+	void GetRange (IT begin, IT end, std::vector<NT> & range) const;	// collective fetch of [begin,end), which may differ across processors
 	NT operator[](IT indx) const		// more c++ like API
 	{
 		return GetElement(indx);
@@ -297,6 +302,9 @@ private:
 	template <class IU, class NU>
 	friend class DenseVectorLocalIterator;
 
+	template <class IU, class NU>
+	friend class FullyDistVecBatch;
+
 	template <typename SR, typename IU, typename NUM, typename NUV, typename UDER>
 	friend FullyDistVec<IU,typename promote_trait<NUM,NUV>::T_promote>
 	SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistVec<IU,NUV> & x );
@@ -0,0 +1,270 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef _FULLY_DIST_VEC_BATCH_H_
+#define _FULLY_DIST_VEC_BATCH_H_
+
+#include <mpi.h>
+#include <vector>
+#include <unordered_map>
+#include "FullyDistVec.h"
+#include "MPIType.h"
+
+namespace combblas {
+
+/**
+ * Batched one-sided access to scattered elements of a FullyDistVec, for codes that read (or write) many remote entries per iteration.
+ * Request() only queues an index and returns a handle; Post() issues a single MPI_Get per owner, with every index asked once,
+ * and the values can be read through the handles after Complete(). Local work between Post() and Complete() overlaps with the transfers.
+ * Fetched values are cached until Clear(), so asking for them again costs nothing. Set() queues writes (the last one per index wins)
+ * and Flush() sends them, again one MPI_Put per owner.
+ * The constructor and the destructor are collective, and the vector must not be resized while a batch is alive. As with any passive
+ * target access, values written by others (remotely or locally) are only guaranteed to be seen after a collective Sync()
+ */
+template <class IT, class NT>
+class FullyDistVecBatch
+{
+public:
+	FullyDistVecBatch(FullyDistVec<IT,NT> & vec): vec(vec), posted(false)
+	{
+		myrank = vec.commGrid->GetRank();
+		int nprocs = vec.commGrid->GetSize();
+		getinds.resize(nprocs);
+		getslots.resize(nprocs);
+		putinds.resize(nprocs);
+		putvals.resize(nprocs);
+		MPI_Win_create(vec.arr.data(), vec.arr.size() * sizeof(NT), sizeof(NT), MPI_INFO_NULL, vec.commGrid->GetWorld(), &win);
+		MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+	}
+	~FullyDistVecBatch()
+	{
+		if(posted)	Complete();
+		Flush();
+		MPI_Win_unlock_all(win);
+		MPI_Win_free(&win);
+	}
+
+	//! Queue a read of vec[globind], the returned handle is valid until Clear(). Local elements are read right away
+	IT Request(IT globind)
+	{
+		auto cached = cache.find(globind);
+		if(cached != cache.end())	return cached->second;
+
+		IT handle = values.size();
+		cache[globind] = handle;
+		IT locind;
+		int owner = vec.Owner(globind, locind);
+		if(owner == myrank)
+		{
+			values.push_back(vec.arr[locind]);
+		}
+		else
+		{
+			values.push_back(NT());
+			getinds[owner].push_back(locind);
+			getslots[owner].push_back(handle);
+		}
+		return handle;
+	}
+
+	//! Start fetching everything requested since the last Post(), only one batch is in flight at a time
+	void Post()
+	{
+		if(posted)	Complete();
+		for(int i=0; i< static_cast<int>(getinds.size()); ++i)
+		{
+			if(getinds[i].empty())	continue;
+			inflight.emplace_back(i, std::move(getslots[i]));
+			std::vector<NT> & staging = inflight.back().staging;
+			staging.resize(getinds[i].size());
+			Transfer(getinds[i], staging.data(), i, true);
+			std::vector<IT>().swap(getinds[i]);
+			getslots[i] = std::vector<IT>();
+		}
+		posted = true;
+	}
+
+	//! Wait for the posted reads (local operation)
+	void Complete()
+	{
+		if(!posted)	return;
+		MPI_Win_flush_local_all(win);
+		for(auto & fetched : inflight)
+		{
+			for(size_t k=0; k< fetched.slots.size(); ++k)
+				values[fetched.slots[k]] = fetched.staging[k];
+		}
+		inflight.clear();
+		posted = false;
+	}
+
+	NT operator[](IT handle) const { return values[handle]; }
+
+	//! Value of vec[globind] if it is already available here (cached by a completed request, or owned)
+	bool Lookup(IT globind, NT & val) const
+	{
+		IT locind;
+		if(vec.Owner(globind, locind) == myrank)
+		{
+			val = vec.arr[locind];
+			return true;
+		}
+		auto cached = cache.find(globind);
+		if(cached == cache.end())	return false;
+		val = values[cached->second];
+		return true;
+	}
+
+	//! Queue vec[globind] = val, cached copies are updated too. Local elements are written right away
+	void Set(IT globind, NT val)
+	{
+		auto cached = cache.find(globind);
+		if(cached != cache.end())	values[cached->second] = val;
+
+		IT locind;
+		int owner = vec.Owner(globind, locind);
+		if(owner == myrank)
+		{
+			vec.arr[locind] = val;
+			return;
+		}
+		auto pending = putpos.find(globind);
+		if(pending != putpos.end())
+		{
+			putvals[owner][pending->second] = val;
+		}
+		else
+		{
+			putpos[globind] = putinds[owner].size();
+			putinds[owner].push_back(locind);
+			putvals[owner].push_back(val);
+		}
+	}
+
+	//! Send the queued writes, they are complete at their targets when this returns
+	void Flush()
+	{
+		bool any = false;
+		for(int i=0; i< static_cast<int>(putinds.size()); ++i)
+		{
+			if(putinds[i].empty())	continue;
+			Transfer(putinds[i], putvals[i].data(), i, false);
+			any = true;
+		}
+		if(any)	MPI_Win_flush_all(win);
+		for(size_t i=0; i< putinds.size(); ++i)
+		{
+			std::vector<IT>().swap(putinds[i]);
+			std::vector<NT>().swap(putvals[i]);
+		}
+		putpos.clear();
+	}
+
+	//! Collective: make the writes of all processes (flushed ones, and local stores to the vector) visible everywhere
+	void Sync()
+	{
+		MPI_Win_sync(win);
+		MPI_Barrier(vec.commGrid->GetWorld());
+		MPI_Win_sync(win);
+	}
+
+	//! Forget the cached values and drop the requests that were not posted (start of a new iteration), handles become invalid
+	void Clear()
+	{
+		Complete();
+		cache.clear();
+		values.clear();
+		for(size_t i=0; i< getinds.size(); ++i)
+		{
+			getinds[i].clear();
+			getslots[i].clear();
+		}
+	}
+
+	IT getncached() const { return values.size(); }
+
+	/**
+	 * Datatype that picks the elements inds[0...count) of the target array, in that order
+	 * Displacements are in bytes, so local arrays beyond 2^31 elements are fine
+	 */
+	static MPI_Datatype ScatteredType(const IT * inds, int count)
+	{
+		std::vector<MPI_Aint> displs(count);
+		for(int k=0; k< count; ++k)
+			displs[k] = static_cast<MPI_Aint>(inds[k]) * sizeof(NT);
+		MPI_Datatype type;
+		MPI_Type_create_hindexed_block(count, 1, displs.data(), MPIType<NT>(), &type);
+		MPI_Type_commit(&type);
+		return type;
+	}
+
+private:
+	struct Fetch
+	{
+		Fetch(int owner, std::vector<IT> && slots): owner(owner), slots(std::move(slots)) {}
+		int owner;
+		std::vector<IT> slots;		// handles to fill
+		std::vector<NT> staging;	// target of the MPI_Get
+	};
+
+	// one MPI_Get (or MPI_Put) per owner, split into pieces of at most 2^30 elements
+	void Transfer(const std::vector<IT> & inds, NT * buffer, int owner, bool get)
+	{
+		const size_t piece = (1 << 30);
+		for(size_t begin = 0; begin < inds.size(); begin += piece)
+		{
+			int count = static_cast<int>(std::min(piece, inds.size() - begin));
+			MPI_Datatype type = ScatteredType(inds.data() + begin, count);
+			if(get)
+				MPI_Get(buffer + begin, count, MPIType<NT>(), owner, 0, 1, type, win);
+			else
+				MPI_Put(buffer + begin, count, MPIType<NT>(), owner, 0, 1, type, win);
+			MPI_Type_free(&type);
+		}
+	}
+
+	FullyDistVec<IT,NT> & vec;
+	MPI_Win win;
+	int myrank;
+	bool posted;
+
+	std::unordered_map<IT, IT> cache;	// global index -> handle
+	std::vector<NT> values;			// indexed by handle
+	std::vector< std::vector<IT> > getinds;		// queued reads, local indices at each owner
+	std::vector< std::vector<IT> > getslots;	// and the handles they fill
+	std::vector<Fetch> inflight;
+
+	std::unordered_map<IT, IT> putpos;	// global index -> position in putinds/putvals of its owner
+	std::vector< std::vector<IT> > putinds;
+	std::vector< std::vector<NT> > putvals;
+};
+
+}
+
+#endif
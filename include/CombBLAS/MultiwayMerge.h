@@ -543,6 +543,66 @@ SpTuples<IT, NT>* MultiwayMerge( std::vector<SpTuples<IT,NT> *> & ArrSpTups, IT
 }
 
 
+/*
+ Incremental (binary counter) merge of column sorted SpTuples
+ Partial products are pushed one at a time, e.g. as SUMMA stages finish.
+ levels[k] holds the merge of 2^k pushed inputs; pushing into an occupied level
+ merges the two and carries the result upwards, like incrementing a binary counter.
+ Hence at most log2(#pushed)+1 partial results are alive at any point in time and
+ each input participates in O(log(#pushed)) two-way merges.
+ The merger owns (and deletes) every SpTuples pushed into it.
+ */
+template<class SR, class IT, class NT>
+class IncrementalMerge
+{
+public:
+    IncrementalMerge(IT mdim, IT ndim): m(mdim), n(ndim) {}
+    ~IncrementalMerge()
+    {
+        for(size_t k=0; k< levels.size(); ++k)
+            delete levels[k];
+    }
+    
+    void Push(SpTuples<IT,NT> * tuples)
+    {
+        if(tuples->isZero())
+        {
+            delete tuples;
+            return;
+        }
+        SpTuples<IT,NT> * carry = tuples;
+        size_t k = 0;
+        for(; k < levels.size() && levels[k] != NULL; ++k)
+        {
+            std::vector<SpTuples<IT,NT> *> pair = {levels[k], carry};
+            carry = MultiwayMerge<SR>(pair, m, n, true);   // deletes both inputs
+            levels[k] = NULL;
+        }
+        if(k == levels.size())
+            levels.push_back(carry);
+        else
+            levels[k] = carry;
+    }
+    
+    // Merges whatever is left and returns it; the merger is empty afterwards
+    SpTuples<IT,NT> * Finish()
+    {
+        std::vector<SpTuples<IT,NT> *> rest;
+        for(size_t k=0; k< levels.size(); ++k)
+        {
+            if(levels[k] != NULL) rest.push_back(levels[k]);
+        }
+        levels.clear();
+        return MultiwayMerge<SR>(rest, m, n, true);
+    }
+    
+private:
+    IT m;
+    IT n;
+    std::vector<SpTuples<IT,NT> *> levels;
+};
+
+
    
     // --------------------------------------------------------
     // Hash-based multiway merge
@@ -700,6 +760,147 @@ SpTuples<IT, NT>* MultiwayMerge( std::vector<SpTuples<IT,NT> *> & ArrSpTups, IT
         return new SpTuples<IT, NT> (mergedNnzAll, mdim, ndim, mergeBuf, true, true);
     }
 
+
+    // --------------------------------------------------------
+    // Hash-based multiway merge fused with the column filter of the MCL expansion (see PruneSelectFilter)
+    // Each merged column is filtered in thread private space, only the surviving entries are written out
+    // Columns of the input matrices may or may not be sorted, columns of the output are sorted
+    // --------------------------------------------------------
+    template<class SR, class IT, class NT>
+    SpTuples<IT, NT>* MultiwayMergePruneSelect( std::vector<SpTuples<IT,NT> *> & ArrSpTups, IT mdim, IT ndim, bool delarrs, PruneSelectFilter<IT,NT> & filter)
+    {
+        int nlists =  ArrSpTups.size();
+        for(int i=0; i< nlists; ++i)
+        {
+            if((mdim != ArrSpTups[i]->getnrow()) || ndim != ArrSpTups[i]->getncol())
+            {
+                std::cerr << "Dimensions of SpTuples do not match on MultiwayMergePruneSelect()" << std::endl;
+                return new SpTuples<IT,NT>(0,0,0);
+            }
+        }
+        
+        int nthreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+        {
+            nthreads = omp_get_num_threads();
+        }
+#endif
+        int nsplits = std::max(1, static_cast<int>(std::min<IT>(4*nthreads, ndim)));  // oversplit for load balance
+        
+        // the split boundaries in every input, whose tuples are sorted by column
+        // scratch is O(nlists*(nsplits+nthreads)), not O(nlists*ndim): wide blocks are walked with one cursor per list
+        std::vector< std::vector<IT> > colPtrs(nlists);
+#ifdef THREADED
+#pragma omp parallel for
+#endif
+        for(int j=0; j< nlists; j++)
+        {
+            colPtrs[j]=findColSplittersFinger<IT>(ArrSpTups[j], nsplits);
+        }
+        
+        std::vector< std::vector< std::tuple<IT,IT,NT> > > splits(nsplits);
+        std::vector<std::vector< std::pair<IT,NT>>> globalHashVecAll(nthreads);
+        std::vector<std::vector< std::tuple<IT,IT,NT>>> columnVecAll(nthreads);
+        std::vector<std::vector< IT >> colBegAll(nthreads, std::vector<IT>(nlists));
+        std::vector<std::vector< IT >> colEndAll(nthreads, std::vector<IT>(nlists));
+        const IT hashScale = 107;
+        
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for(int s=0; s < nsplits; ++s)
+        {
+            int myThread = 0;
+#ifdef THREADED
+            myThread = omp_get_thread_num();
+#endif
+            IT * colBeg = colBegAll[myThread].data();   // cursor of every list
+            IT * colEnd = colEndAll[myThread].data();   // end of the current column in every list
+            for(int j=0; j< nlists; ++j)
+                colBeg[j] = colPtrs[j][s];
+            while(true)
+            {
+                // the next column is the smallest column any list is at, empty columns are skipped
+                IT col = ndim;
+                for(int j=0; j< nlists; ++j)
+                {
+                    if(colBeg[j] < colPtrs[j][s+1])
+                        col = std::min(col, ArrSpTups[j]->colindex(colBeg[j]));
+                }
+                if(col == ndim) break;
+                
+                size_t inputnnz = 0;
+                for(int j=0; j< nlists; ++j)
+                {
+                    colEnd[j] = colBeg[j];
+                    while(colEnd[j] < colPtrs[j][s+1] && ArrSpTups[j]->colindex(colEnd[j]) == col)
+                        ++colEnd[j];
+                    inputnnz += colEnd[j] - colBeg[j];
+                }
+                
+                size_t ht_size = 16;
+                while(ht_size < inputnnz) //ht_size is set as 2^n
+                {
+                    ht_size <<= 1;
+                }
+                if(globalHashVecAll[myThread].size() < ht_size)
+                    globalHashVecAll[myThread].resize(ht_size);
+                if(columnVecAll[myThread].size() < inputnnz)
+                    columnVecAll[myThread].resize(inputnnz);
+                std::pair<IT,NT> * globalHashVec = globalHashVecAll[myThread].data();
+                for(size_t k=0; k < ht_size; ++k)
+                    globalHashVec[k].first = -1;
+                
+                for(int j=0; j< nlists; ++j)
+                {
+                    for(IT k = colBeg[j]; k < colEnd[j]; ++k)
+                    {
+                        IT key = ArrSpTups[j]->rowindex(k);
+                        IT hash = (key*hashScale) & (ht_size-1);
+                        while (1) //hash probing
+                        {
+                            if (globalHashVec[hash].first == key) //key is found in hash table
+                            {
+                                globalHashVec[hash].second = SR::add(ArrSpTups[j]->numvalue(k), globalHashVec[hash].second);
+                                break;
+                            }
+                            else if (globalHashVec[hash].first == -1) //key is not registered yet
+                            {
+                                globalHashVec[hash].first = key;
+                                globalHashVec[hash].second = ArrSpTups[j]->numvalue(k);
+                                break;
+                            }
+                            else //key is not found
+                            {
+                                hash = (hash+1) & (ht_size-1);
+                            }
+                        }
+                    }
+                }
+                
+                std::tuple<IT,IT,NT> * column = columnVecAll[myThread].data();
+                IT len = 0;
+                for(size_t k=0; k < ht_size; ++k)
+                {
+                    if(globalHashVec[k].first != -1)
+                        column[len++] = std::make_tuple(globalHashVec[k].first, col, globalHashVec[k].second);
+                }
+                IT nkeep = filter.Filter(column, len);
+                splits[s].insert(splits[s].end(), column, column + nkeep);
+                for(int j=0; j< nlists; ++j)
+                    colBeg[j] = colEnd[j];
+            }
+        }
+        
+        for(int i=0; i< nlists; i++)
+        {
+            if(delarrs)
+                delete ArrSpTups[i]; // May be expensive for large local matrices
+        }
+        return ConcatenateColumnSplits(splits, mdim, ndim);
+    }
+
     // --------------------------------------------------------
     // Hash-based multiway merge
     // Columns of the input matrices may or may not be sorted
@@ -39,6 +39,7 @@
 #include "MPIType.h"
 #include "Friends.h"
 #include "OptBuf.h"
+#include "SpMSpVContext.h"
 #include "mtSpGEMM.h"
 #include "MultiwayMerge.h"
 #include <unistd.h>
@@ -132,7 +133,7 @@ FullyDistVec<IT,NT> Concatenate ( std::vector< FullyDistVec<IT,NT> > & vecs)
 			std::vector<NT>().swap(data[i]);	// delete data vectors
 		}
 		NT * recvdatabuf = new NT[totrecv];
-		MPI_Alltoallv(senddatabuf, sendcnt, sdispls, MPIType<NT>(), recvdatabuf, recvcnt, rdispls, MPIType<NT>(), World);  // send data
+		SpParHelper::Alltoallv(senddatabuf, sendcnt, sdispls, MPIType<NT>(), recvdatabuf, recvcnt, rdispls, MPIType<NT>(), World);  // send data
 		delete [] senddatabuf;
 		
 		IT * sendindsbuf = new IT[cumloclen];
@@ -142,7 +143,7 @@ FullyDistVec<IT,NT> Concatenate ( std::vector< FullyDistVec<IT,NT> > & vecs)
 			std::vector<IT>().swap(inds[i]);	// delete inds vectors
 		}
 		IT * recvindsbuf = new IT[totrecv];
-		MPI_Alltoallv(sendindsbuf, sendcnt, sdispls, MPIType<IT>(), recvindsbuf, recvcnt, rdispls, MPIType<IT>(), World);  // send new inds
+		SpParHelper::Alltoallv(sendindsbuf, sendcnt, sdispls, MPIType<IT>(), recvindsbuf, recvcnt, rdispls, MPIType<IT>(), World);  // send new inds
 		DeleteAll(sendindsbuf, sendcnt, sdispls);
 
 		for(int i=0; i<nprocs; ++i)
@@ -182,8 +183,10 @@ bool CheckSpGEMMCompliance(const MATRIXA & A, const MATRIXB & B)
 
 
 // Combined logic for prune, recovery, and select
+// colSums and nnzPerColumn are the column sums and counts of A after hard thresholding, nnzPerColumnUnpruned are the counts before
 template <typename IT, typename NT, typename DER>
-void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT selectNum, IT recoverNum, NT recoverPct, int kselectVersion)
+void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT selectNum, IT recoverNum, NT recoverPct, int kselectVersion,
+                            FullyDistVec<IT,NT> & colSums, FullyDistVec<IT,NT> & nnzPerColumn, FullyDistVec<IT,NT> & nnzPerColumnUnpruned)
 {
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
@@ -192,19 +195,10 @@ void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT select
     double t0, t1;
 #endif
     
-    // Prune and create a new pruned matrix
-    SpParMat<IT,NT,DER> PrunedA = A.Prune([hardThreshold](NT val){ return val <= hardThreshold; }, false);
-
-    // column-wise statistics of the pruned matrix
-    FullyDistVec<IT,NT> colSums = PrunedA.Reduce(Column, std::plus<NT>(), 0.0);
-    FullyDistVec<IT,NT> nnzPerColumnUnpruned = A.Reduce(Column, std::plus<NT>(), 0.0, [](NT val){return 1.0;});
-    FullyDistVec<IT,NT> nnzPerColumn = PrunedA.Reduce(Column, std::plus<NT>(), 0.0, [](NT val){return 1.0;});
     //FullyDistVec<IT,NT> pruneCols(A.getcommgrid(), A.getncol(), hardThreshold);
     FullyDistVec<IT,NT> pruneCols(nnzPerColumn);
     pruneCols = hardThreshold;
 
-    PrunedA.FreeMemory();
-
 	FullyDistSpVec<IT,NT> recoverCols(nnzPerColumn, [recoverNum](const NT& val) { return val < recoverNum; });
     
     // recover only when nnzs in unprunned columns are greater than nnzs in pruned column
@@ -353,6 +347,56 @@ void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT select
 
 }
 
+template <typename IT, typename NT, typename DER>
+void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT selectNum, IT recoverNum, NT recoverPct, int kselectVersion)
+{
+    // Prune and create a new pruned matrix
+    SpParMat<IT,NT,DER> PrunedA = A.Prune([hardThreshold](NT val){ return val <= hardThreshold; }, false);
+
+    // column-wise statistics of the pruned matrix
+    FullyDistVec<IT,NT> colSums = PrunedA.Reduce(Column, std::plus<NT>(), 0.0);
+    FullyDistVec<IT,NT> nnzPerColumnUnpruned = A.Reduce(Column, std::plus<NT>(), 0.0, [](NT val){return 1.0;});
+    FullyDistVec<IT,NT> nnzPerColumn = PrunedA.Reduce(Column, std::plus<NT>(), 0.0, [](NT val){return 1.0;});
+
+    PrunedA.FreeMemory();
+
+    MCLPruneRecoverySelect(A, hardThreshold, selectNum, recoverNum, recoverPct, kselectVersion, colSums, nnzPerColumn, nnzPerColumnUnpruned);
+}
+
+/**
+ * Sum of a per local column array over the processor column, distributed like the output of A.Reduce(Column, ...)
+ * The array is stored as the first local row of a temporary matrix with the same distribution as A, then reduced
+ **/
+template <typename IT, typename NT, typename DER>
+FullyDistVec<IT,NT> ReduceLocalColumns(SpParMat<IT,NT,DER> & A, const std::vector<NT> & loccols)
+{
+    typedef typename DER::LocalIT LIT;
+    std::vector< std::tuple<LIT,LIT,NT> > tuples;
+    for(LIT j=0; j < static_cast<LIT>(loccols.size()); ++j)
+    {
+        if(loccols[j] != 0) tuples.push_back(std::make_tuple(static_cast<LIT>(0), j, loccols[j]));
+    }
+    if(A.getlocalrows() == 0) tuples.clear();
+    DER * seq = new DER(A.getlocalrows(), A.getlocalcols(), static_cast<LIT>(tuples.size()), tuples.data(), false);
+    SpParMat<IT,NT,DER> S(seq, A.getcommgrid());
+    return S.Reduce(Column, std::plus<NT>(), static_cast<NT>(0));
+}
+
+/**
+ * Prune, recovery, and select for a matrix produced by LocalSpGEMMPruneSelect or MultiwayMergePruneSelect,
+ * whose columns were already reduced to their candidates, using the statistics recorded by the filter
+ **/
+template <typename IT, typename NT, typename DER>
+void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, const PruneSelectFilter<typename DER::LocalIT,NT> & filter, NT recoverPct, int kselectVersion)
+{
+    FullyDistVec<IT,NT> colSums = ReduceLocalColumns(A, filter.prunedSums);
+    FullyDistVec<IT,NT> nnzPerColumn = ReduceLocalColumns(A, filter.prunedNnz);
+    FullyDistVec<IT,NT> nnzPerColumnUnpruned = ReduceLocalColumns(A, filter.unprunedNnz);
+    IT selectNum = filter.selectNum;
+    IT recoverNum = filter.recoverNum;
+    MCLPruneRecoverySelect(A, filter.hardThreshold, selectNum, recoverNum, recoverPct, kselectVersion, colSums, nnzPerColumn, nnzPerColumnUnpruned);
+}
+
 template <typename SR, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB> 
 IU EstimateFLOP 
 		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false)
@@ -423,14 +467,10 @@ IU EstimateFLOP
 						i != Bself);	// 'delete B' condition
 	}
 
-	if(clearA && A.spSeq != NULL) {	
-		delete A.spSeq;
-		A.spSeq = NULL;
-	}	
-	if(clearB && B.spSeq != NULL) {
-		delete B.spSeq;
-		B.spSeq = NULL;
-	}
+	if(clearA)
+		A.FreeMemory();
+	if(clearB)
+		B.FreeMemory();
 
 	SpHelper::deallocate2D(ARecvSizes, UDERA::esscount);
 	SpHelper::deallocate2D(BRecvSizes, UDERB::esscount);
@@ -447,11 +487,14 @@ IU EstimateFLOP
  * Broadcasts A multiple times (#phases) in order to save storage in the output
  * Only uses 1/phases of C memory if the threshold/max limits are proper
  * Parameters:
- *  - computationKernel: 1 means hash-based, 2 means heap-based
+ *  - computationKernel: 0 means the accumulator is selected per column (LocalAdaptiveSpGEMM), 1 means hash-based, 2 means heap-based
+ *  - perProcessMemory: memory (GB) per process used to pick the number of phases from a symbolic estimate of the output,
+ *    a negative value reads the available memory from /proc/meminfo and the memory cgroup instead, 0 keeps the given phases
+ *  - fusePruneSelect: filter columns of C while they are accumulated (PruneSelectFilter), so that they are never materialized in full
  */
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
 SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
-                                           int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int computationKernel, int64_t perProcessMemory)
+                                           int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int computationKernel, int64_t perProcessMemory, bool fusePruneSelect = false)
 {
     typedef typename UDERA::LocalIT LIA;
     typedef typename UDERB::LocalIT LIB;
@@ -482,7 +525,7 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
     MPI_Barrier(A.getcommgrid()->GetWorld());
     t0 = MPI_Wtime();
 #endif
-    if(perProcessMemory>0) // estimate the number of phases permitted by memory
+    if(perProcessMemory != 0) // estimate the number of phases permitted by memory
     {
         int p;
         MPI_Comm World = GridC->GetWorld();
@@ -498,7 +541,7 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
         int64_t inputMem = gannz * perNNZMem_in * 4; // for four copies (two for SUMMA)
         
         // max nnz(A^2) stored by SUMMA in a porcess
-        int64_t asquareNNZ = EstPerProcessNnzSUMMA(A,B, false);
+        int64_t asquareNNZ = EstPerProcessNnzSUMMA(A,B, true);
 		int64_t asquareMem = asquareNNZ * perNNZMem_out * 2; // an extra copy in multiway merge and in selection/recovery step
         
         
@@ -512,8 +555,12 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
         int64_t outputNNZ = (B.getlocalcols() * k)/sqrt(p);
         int64_t outputMem = outputNNZ * perNNZMem_in * 2;
         
+        // negative perProcessMemory: use what is actually available on the node at this point (re-measured in every call,
+        // so iterative applications adapt the number of phases); our own copies of A and B are already resident, hence added back
+        int64_t memoryBudget = (perProcessMemory > 0) ? perProcessMemory*1000000000 : SpParHelper::AvailableMemory(World) + gannz * perNNZMem_in * 2;
+        
         //inputMem + outputMem + asquareMem/phases + kselectmem/phases < memory
-        int64_t remainingMem = perProcessMemory*1000000000 - inputMem - outputMem;
+        int64_t remainingMem = memoryBudget - inputMem - outputMem;
         if(remainingMem > 0)
         {
             phases = 1 + (asquareMem+kselectmem) / remainingMem;
@@ -529,9 +576,9 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
 #ifdef SHOW_MEMORY_USAGE
             int64_t maxMemory = kselectmem/phases + inputMem + outputMem + asquareMem / phases;
             if(maxMemory>1000000000)
-            std::cout << "phases: " << phases << ": per process memory: " << perProcessMemory << " GB asquareMem: " << asquareMem/1000000000.00 << " GB" << " inputMem: " << inputMem/1000000000.00 << " GB" << " outputMem: " << outputMem/1000000000.00 << " GB" << " kselectmem: " << kselectmem/1000000000.00 << " GB" << std::endl;
+            std::cout << "phases: " << phases << ": per process memory: " << memoryBudget/1000000000.00 << " GB asquareMem: " << asquareMem/1000000000.00 << " GB" << " inputMem: " << inputMem/1000000000.00 << " GB" << " outputMem: " << outputMem/1000000000.00 << " GB" << " kselectmem: " << kselectmem/1000000000.00 << " GB" << std::endl;
             else
-            std::cout << "phases: " << phases << ": per process memory: " << perProcessMemory << " GB asquareMem: " << asquareMem/1000000.00 << " MB" << " inputMem: " << inputMem/1000000.00 << " MB" << " outputMem: " << outputMem/1000000.00 << " MB" << " kselectmem: " << kselectmem/1000000.00 << " MB" << std::endl;
+            std::cout << "phases: " << phases << ": per process memory: " << memoryBudget/1000000000.00 << " GB asquareMem: " << asquareMem/1000000.00 << " MB" << " inputMem: " << inputMem/1000000.00 << " MB" << " outputMem: " << outputMem/1000000.00 << " MB" << " kselectmem: " << kselectmem/1000000.00 << " MB" << std::endl;
 #endif
             
         }
@@ -580,6 +627,7 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
     {
         SpParHelper::GetSetSizes( PiecesOfB[p], BRecvSizes, (B.commGrid)->GetColWorld());
         std::vector< SpTuples<LIC,NUO>  *> tomerge;
+        PruneSelectFilter<LIC,NUO> filter(hardThreshold, static_cast<LIC>(selectNum), static_cast<LIC>(recoverNum), PiecesOfB[p].getncol());
         for(int i = 0; i < stages; ++i)
         {
             std::vector<LIA> ess;
@@ -656,7 +704,9 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
             SpTuples<LIC,NUO> * C_cont;
             //if(computationKernel == 1) C_cont = LocalSpGEMMHash<SR, NUO>(*ARecv, *BRecv,i != Aself, i != Bself, false); // Hash SpGEMM without per-column sorting
             //else if(computationKernel == 2) C_cont=LocalSpGEMM<SR, NUO>(*ARecv, *BRecv,i != Aself, i != Bself);
-            if(computationKernel == 1) C_cont = LocalSpGEMMHash<SR, NUO>(*ARecv, *BRecv, false, false, false); // Hash SpGEMM without per-column sorting
+            if(fusePruneSelect && stages == 1) C_cont = LocalSpGEMMPruneSelect<SR, NUO>(*ARecv, *BRecv, false, false, filter); // the only stage, columns are final
+            else if(computationKernel == 0) C_cont = LocalAdaptiveSpGEMM<SR, NUO>(*ARecv, *BRecv, false, false);
+            else if(computationKernel == 1) C_cont = LocalSpGEMMHash<SR, NUO>(*ARecv, *BRecv, false, false, false); // Hash SpGEMM without per-column sorting
             else if(computationKernel == 2) C_cont=LocalSpGEMM<SR, NUO>(*ARecv, *BRecv, false, false);
             
             // Explicitly delete ARecv and BRecv because it effectively does not get freed inside LocalSpGEMM function
@@ -711,7 +761,10 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
 #endif
         // TODO: MultiwayMerge can directly return UDERO inorder to avoid the extra copy
         SpTuples<LIC,NUO> * OnePieceOfC_tuples;
-        if(computationKernel == 1) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, false);
+        if(fusePruneSelect && stages > 1) OnePieceOfC_tuples = MultiwayMergePruneSelect<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, filter);
+        else if(fusePruneSelect) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, true);  // already filtered
+        else if(computationKernel == 0) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, true);
+        else if(computationKernel == 1) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, false);
         else if(computationKernel == 2) OnePieceOfC_tuples = MultiwayMerge<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true);
         
 #ifdef SHOW_MEMORY_USAGE
@@ -741,7 +794,8 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
         delete OnePieceOfC_tuples;
         
         SpParMat<IU,NUO,UDERO> OnePieceOfC_mat(OnePieceOfC, GridC);
-        MCLPruneRecoverySelect(OnePieceOfC_mat, hardThreshold, selectNum, recoverNum, recoverPct, kselectVersion);
+        if(fusePruneSelect) MCLPruneRecoverySelect(OnePieceOfC_mat, filter, recoverPct, kselectVersion);
+        else MCLPruneRecoverySelect(OnePieceOfC_mat, hardThreshold, selectNum, recoverNum, recoverPct, kselectVersion);
 
 #ifdef SHOW_MEMORY_USAGE
         int64_t gcnnz_pruned, lcnnz_pruned ;
@@ -776,10 +830,20 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
     return SpParMat<IU,NUO,UDERO> (C, GridC);
 }
 
+/**
+ * Number of phases MemEfficientSpGEMM needs so that one phase of C = A*B fits in memory
+ * perProcessMemory has the same meaning as in MemEfficientSpGEMM: memory (GB) per process, a negative value
+ * measures the available memory instead, and 0 means no limit, i.e. a single phase (there is no given value to keep)
+ * If even the inputs do not fit, the largest sensible number of phases (one local column of B each) is returned:
+ * this minimizes the memory of a phase, but the program may still run out of memory
+ */
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
 int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
         NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int64_t perProcessMemory){
     
+    if(perProcessMemory == 0)
+        return 1;
+    
     int phases;
 
     int myrank;
@@ -803,7 +867,7 @@ int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB>
     int64_t inputMem = gannz * perNNZMem_in * 4; // for four copies (two for SUMMA)
     
     // max nnz(A^2) stored by SUMMA in a porcess
-    int64_t asquareNNZ = EstPerProcessNnzSUMMA(A,B, false);
+    int64_t asquareNNZ = EstPerProcessNnzSUMMA(A,B, true);
     int64_t asquareMem = asquareNNZ * perNNZMem_out * 2; // an extra copy in multiway merge and in selection/recovery step
     
     
@@ -820,12 +884,21 @@ int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB>
     
     //inputMem + outputMem + asquareMem/phases + kselectmem/phases < memory
     //int64_t remainingMem = perProcessMemory*1000000000 - inputMem - outputMem;
-    int64_t remainingMem = perProcessMemory*1000000000 - inputMem; // if each phase result is discarded
+    // negative perProcessMemory: use the memory actually available on the node (see MemEfficientSpGEMM)
+    int64_t memoryBudget = (perProcessMemory > 0) ? perProcessMemory*1000000000 : SpParHelper::AvailableMemory(World) + gannz * perNNZMem_in * 2;
+    int64_t remainingMem = memoryBudget - inputMem; // if each phase result is discarded
     //if(remainingMem > 0)
     //{
         //phases = 1 + (asquareMem+kselectmem) / remainingMem;
     //}
-    phases = 1 + asquareMem / remainingMem;
+    if(remainingMem > 0)
+        phases = 1 + asquareMem / remainingMem;
+    else    // inputs alone do not fit, see the function comment
+    {
+        phases = std::max(1, (int) std::min(B.getlocalcols(), (IU) std::numeric_limits<int>::max()));
+        if(myrank == 0)
+            std::cout << "Warning: input memory requirement is greater than per-process available memory. Using " << phases << " phases, the program may go out of memory and crash!" << std::endl;
+    }
     return phases;
 }
 
@@ -1106,7 +1179,8 @@ SpParMat<ITA, NTA, DERA> IncrementalMCLSquare(SpParMat<ITA, NTA, DERA> & A,
             SpTuples<ITA,NTA> * C_cont;
             //if(computationKernel == 1) C_cont = LocalSpGEMMHash<SR, NUO>(*ARecv, *BRecv,i != Aself, i != Bself, false); // Hash SpGEMM without per-column sorting
             //else if(computationKernel == 2) C_cont=LocalSpGEMM<SR, NUO>(*ARecv, *BRecv,i != Aself, i != Bself);
-            if(computationKernel == 1) C_cont = LocalSpGEMMHash<SR, NTA>(*ARecv, *BRecv, false, false, false); // Hash SpGEMM without per-column sorting
+            if(computationKernel == 0) C_cont = LocalAdaptiveSpGEMM<SR, NTA>(*ARecv, *BRecv, false, false);
+            else if(computationKernel == 1) C_cont = LocalSpGEMMHash<SR, NTA>(*ARecv, *BRecv, false, false, false); // Hash SpGEMM without per-column sorting
             else if(computationKernel == 2) C_cont=LocalSpGEMM<SR, NTA>(*ARecv, *BRecv, false, false);
             
             // Explicitly delete ARecv and BRecv because it effectively does not get freed inside LocalSpGEMM function
@@ -1161,7 +1235,8 @@ SpParMat<ITA, NTA, DERA> IncrementalMCLSquare(SpParMat<ITA, NTA, DERA> & A,
 #endif
         // TODO: MultiwayMerge can directly return UDERO inorder to avoid the extra copy
         SpTuples<ITA,NTA> * OnePieceOfC_tuples;
-        if(computationKernel == 1) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, false);
+        if(computationKernel == 0) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, true);
+        else if(computationKernel == 1) OnePieceOfC_tuples = MultiwayMergeHash<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true, false);
         else if(computationKernel == 2) OnePieceOfC_tuples = MultiwayMerge<SR>(tomerge, C_m, PiecesOfB[p].getncol(), true);
         
 #ifdef SHOW_MEMORY_USAGE
@@ -1408,8 +1483,7 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 	if(clearA) 
 	{
 		delete A2seq;
-		delete A.spSeq;
-		A.spSeq = NULL;
+		A.FreeMemory();
 	}
 	else
 	{
@@ -1420,8 +1494,7 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 	if(clearB) 
 	{
 		delete B2seq;
-		delete B.spSeq;
-		B.spSeq = NULL;	
+		B.FreeMemory();
 	}
 	else
 	{
@@ -1442,11 +1515,14 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 /**
  * Parallel A = B*C routine that uses only MPI-1 features
  * Relies on simple blocking broadcast
+ * The accumulator of every output column of a stage is picked at run time by LocalAdaptiveSpGEMM
+ * @param[in] incrementalMerge {if true, stage outputs are merged as they are produced (see IncrementalMerge)
+ *		instead of all at the end, so that only O(log stages) partial products are alive at a time}
  * @pre { Input matrices, A and B, should not alias }
  **/  
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB> 
 SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch 
-		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
+		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false, bool incrementalMerge = false )
 
 {
     int myrank;
@@ -1475,6 +1551,7 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
 	UDERA * ARecv; 
 	UDERB * BRecv;
 	std::vector< SpTuples<LIC,NUO>  *> tomerge;
+	IncrementalMerge<SR,LIC,NUO> merger(C_m, C_n);
 
 	int Aself = (A.commGrid)->GetRankInProcRow();
 	int Bself = (B.commGrid)->GetRankInProcCol();	
@@ -1513,7 +1590,7 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
 		}
 		SpParHelper::BCastMatrix(GridC->GetColWorld(), *BRecv, ess, i);	// then, receive its elements
         
-		SpTuples<LIC,NUO> * C_cont = LocalHybridSpGEMM<SR, NUO>
+		SpTuples<LIC,NUO> * C_cont = LocalAdaptiveSpGEMM<SR, NUO>
 						(*ARecv, *BRecv, // parameters themselves
 						false, 	// 'delete A' condition
 						false);	// 'delete B' condition
@@ -1521,7 +1598,9 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
         if(i != Bself && (!BRecv->isZero())) delete BRecv;
         if(i != Aself && (!ARecv->isZero())) delete ARecv;
 		
-		if(!C_cont->isZero()) 
+		if(incrementalMerge)
+			merger.Push(C_cont);
+		else if(!C_cont->isZero()) 
 			tomerge.push_back(C_cont);
 
 #ifdef COMBBLAS_DEBUG
@@ -1531,21 +1610,15 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
 #endif
 	}
 
-	if(clearA && A.spSeq != NULL) 
-	{	
-		delete A.spSeq;
-		A.spSeq = NULL;
-	}	
-	if(clearB && B.spSeq != NULL) 
-	{
-		delete B.spSeq;
-		B.spSeq = NULL;
-	}
+	if(clearA)
+		A.FreeMemory();
+	if(clearB)
+		B.FreeMemory();
 
 	SpHelper::deallocate2D(ARecvSizes, UDERA::esscount);
 	SpHelper::deallocate2D(BRecvSizes, UDERB::esscount);
 
-    SpTuples<LIC,NUO> * C_tuples = MultiwayMerge<SR>(tomerge, C_m, C_n,true); // Last parameter to delete input tuples
+    SpTuples<LIC,NUO> * C_tuples = incrementalMerge? merger.Finish() : MultiwayMerge<SR>(tomerge, C_m, C_n,true); // Last parameter to delete input tuples
     UDERO * C = new UDERO(*C_tuples, false); // Last parameter to prevent transpose
     delete C_tuples;
 
@@ -1661,14 +1734,10 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Overlap
                     stages-1 != Bself);	// 'delete B' condition
     if(!C_cont->isZero()) tomerge.push_back(C_cont);
 
-	if(clearA && A.spSeq != NULL) {	
-		delete A.spSeq;
-		A.spSeq = NULL;
-	}	
-	if(clearB && B.spSeq != NULL) {
-		delete B.spSeq;
-		B.spSeq = NULL;
-	}
+	if(clearA)
+		A.FreeMemory();
+	if(clearB)
+		B.FreeMemory();
 
     delete[] ARecv;
     delete[] BRecv;
@@ -1689,9 +1758,249 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Overlap
 	return SpParMat<IU,NUO,UDERO> (C, GridC);		// return the result object
 }
 
+/**
+ * Parallel C = A*B routine that pipelines the SUMMA broadcasts
+ * The A and B panels of stage i+1 are posted with IBCastMatrix before the
+ * (multithreaded) local multiplication of stage i starts, so that the broadcast
+ * of the next stage proceeds while the current one is being computed.
+ * Only two stages are in flight at any time, hence the memory footprint is that
+ * of Mult_AnXBn_Synch plus one extra pair of received panels.
+ * @param[in] incrementalMerge {same as in Mult_AnXBn_Synch}
+ * @pre { Input matrices, A and B, should not alias }
+ **/
+template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
+SpParMat<IU, NUO, UDERO> Mult_AnXBn_Pipelined
+		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false, bool incrementalMerge = false )
+{
+    typedef typename UDERA::LocalIT LIA;
+    typedef typename UDERB::LocalIT LIB;
+    typedef typename UDERO::LocalIT LIC;
+	if(!CheckSpGEMMCompliance(A,B) )
+	{
+		return SpParMat< IU,NUO,UDERO >();
+	}
+	int stages, dummy; 	// last two parameters of ProductGrid are ignored for this multiplication
+	std::shared_ptr<CommGrid> GridC = ProductGrid((A.commGrid).get(), (B.commGrid).get(), stages, dummy, dummy);
+	LIA C_m = A.spSeq->getnrow();
+	LIB C_n = B.spSeq->getncol();
+
+    LIA ** ARecvSizes = SpHelper::allocate2D<LIA>(UDERA::esscount, stages);
+    LIB ** BRecvSizes = SpHelper::allocate2D<LIB>(UDERB::esscount, stages);
+
+	SpParHelper::GetSetSizes( *(A.spSeq), ARecvSizes, (A.commGrid)->GetRowWorld());
+	SpParHelper::GetSetSizes( *(B.spSeq), BRecvSizes, (B.commGrid)->GetColWorld());
+
+	int Aself = (A.commGrid)->GetRankInProcRow();
+	int Bself = (B.commGrid)->GetRankInProcCol();
+
+	// Two slots, indexed by stage parity: one being computed on, one being received
+	UDERA * ARecv[2] = {NULL, NULL};
+	UDERB * BRecv[2] = {NULL, NULL};
+	std::vector<MPI_Request> AIndReqs[2], ANumReqs[2];
+	std::vector<MPI_Request> BIndReqs[2], BNumReqs[2];
+	Arr<LIA,NU1> Aarrinfo = A.spSeq->GetArrays();
+	Arr<LIB,NU2> Barrinfo = B.spSeq->GetArrays();
+
+	// post the nonblocking broadcasts of the ith stage into slot i%2
+	auto PostStage = [&](int i)
+	{
+		int slot = i % 2;
+		std::vector<LIA> essA;
+		if(i == Aself)	ARecv[slot] = A.spSeq;	// shallow-copy
+		else
+		{
+			essA.resize(UDERA::esscount);
+			for(int j=0; j< UDERA::esscount; ++j)	essA[j] = ARecvSizes[j][i];
+			ARecv[slot] = new UDERA();
+		}
+		AIndReqs[slot].assign(Aarrinfo.indarrs.size(), MPI_REQUEST_NULL);
+		ANumReqs[slot].assign(Aarrinfo.numarrs.size(), MPI_REQUEST_NULL);
+		SpParHelper::IBCastMatrix(GridC->GetRowWorld(), *(ARecv[slot]), essA, i, AIndReqs[slot], ANumReqs[slot]);
+
+		std::vector<LIB> essB;
+		if(i == Bself)	BRecv[slot] = B.spSeq;	// shallow-copy
+		else
+		{
+			essB.resize(UDERB::esscount);
+			for(int j=0; j< UDERB::esscount; ++j)	essB[j] = BRecvSizes[j][i];
+			BRecv[slot] = new UDERB();
+		}
+		BIndReqs[slot].assign(Barrinfo.indarrs.size(), MPI_REQUEST_NULL);
+		BNumReqs[slot].assign(Barrinfo.numarrs.size(), MPI_REQUEST_NULL);
+		SpParHelper::IBCastMatrix(GridC->GetColWorld(), *(BRecv[slot]), essB, i, BIndReqs[slot], BNumReqs[slot]);
+	};
+
+	std::vector< SpTuples<LIC,NUO>  *> tomerge;
+	IncrementalMerge<SR,LIC,NUO> merger(C_m, C_n);
+	PostStage(0);
+	for(int i = 0; i < stages; ++i)
+	{
+		int slot = i % 2;
+		if(i+1 < stages)
+		{
+			PostStage(i+1);		// prefetch the next stage before computing this one
+			int flag;	// give the progress engine a chance to start the new broadcasts
+			MPI_Testall(AIndReqs[1-slot].size(), AIndReqs[1-slot].data(), &flag, MPI_STATUSES_IGNORE);
+			MPI_Testall(ANumReqs[1-slot].size(), ANumReqs[1-slot].data(), &flag, MPI_STATUSES_IGNORE);
+			MPI_Testall(BIndReqs[1-slot].size(), BIndReqs[1-slot].data(), &flag, MPI_STATUSES_IGNORE);
+			MPI_Testall(BNumReqs[1-slot].size(), BNumReqs[1-slot].data(), &flag, MPI_STATUSES_IGNORE);
+		}
+		MPI_Waitall(AIndReqs[slot].size(), AIndReqs[slot].data(), MPI_STATUSES_IGNORE);
+		MPI_Waitall(ANumReqs[slot].size(), ANumReqs[slot].data(), MPI_STATUSES_IGNORE);
+		MPI_Waitall(BIndReqs[slot].size(), BIndReqs[slot].data(), MPI_STATUSES_IGNORE);
+		MPI_Waitall(BNumReqs[slot].size(), BNumReqs[slot].data(), MPI_STATUSES_IGNORE);
+
+		SpTuples<LIC,NUO> * C_cont = LocalHybridSpGEMM<SR, NUO>
+						(*(ARecv[slot]), *(BRecv[slot]), // parameters themselves
+						false, 	// 'delete A' condition
+						false);	// 'delete B' condition
+
+		if(i != Bself)	delete BRecv[slot];
+		if(i != Aself)	delete ARecv[slot];
+		BRecv[slot] = NULL;
+		ARecv[slot] = NULL;
+
+		if(incrementalMerge)
+			merger.Push(C_cont);
+		else if(!C_cont->isZero())
+			tomerge.push_back(C_cont);
+		else
+			delete C_cont;
+
+#ifdef COMBBLAS_DEBUG
+   		std::ostringstream outs;
+		outs << i << "th SUMMA iteration"<< std::endl;
+		SpParHelper::Print(outs.str());
+#endif
+	}
+
+	if(clearA)
+		A.FreeMemory();
+	if(clearB)
+		B.FreeMemory();
+
+	SpHelper::deallocate2D(ARecvSizes, UDERA::esscount);
+	SpHelper::deallocate2D(BRecvSizes, UDERB::esscount);
+
+    SpTuples<LIC,NUO> * C_tuples = incrementalMerge? merger.Finish() : MultiwayMerge<SR>(tomerge, C_m, C_n,true); // Last parameter to delete input tuples
+    UDERO * C = new UDERO(*C_tuples, false); // Last parameter to prevent transpose
+    delete C_tuples;
+
+	return SpParMat<IU,NUO,UDERO> (C, GridC);		// return the result object
+}
+
+
+/**
+ * Parallel masked multiplication C<M> = A*B, or C<!M> = A*B if complement is set
+ * Equivalent to EWiseMult(A*B, M, complement) but each SUMMA stage only computes the
+ * entries allowed by the local block of M (see LocalSpGEMMMasked), which has the same
+ * distribution as C. Therefore neither the unmasked product nor its partial products
+ * are ever formed. Only the sparsity structure of M is used, not its values.
+ * @pre { M is A.getnrow()-by-B.getncol() and lives on the same grid as the product }
+ **/
+template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename NUM, typename UDERA, typename UDERB, typename UDERM>
+SpParMat<IU, NUO, UDERO> Mult_AnXBn_Masked
+		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, const SpParMat<IU,NUM,UDERM> & M,
+		 bool complement = false, bool clearA = false, bool clearB = false )
+{
+    typedef typename UDERA::LocalIT LIA;
+    typedef typename UDERB::LocalIT LIB;
+    typedef typename UDERO::LocalIT LIC;
+	if(!CheckSpGEMMCompliance(A,B) )
+	{
+		return SpParMat< IU,NUO,UDERO >();
+	}
+	int stages, dummy; 	// last two parameters of ProductGrid are ignored for this multiplication
+	std::shared_ptr<CommGrid> GridC = ProductGrid((A.commGrid).get(), (B.commGrid).get(), stages, dummy, dummy);
+	if(M.getnrow() != A.getnrow() || M.getncol() != B.getncol() || *(M.commGrid) != *GridC)
+	{
+		std::ostringstream outs;
+		outs << "Can not multiply, mask is not conformant with the product"<< std::endl;
+		outs << M.getnrow() << "x" << M.getncol() << " != " << A.getnrow() << "x" << B.getncol() << std::endl;
+		SpParHelper::Print(outs.str());
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+		return SpParMat< IU,NUO,UDERO >();
+	}
+	LIA C_m = A.spSeq->getnrow();
+	LIB C_n = B.spSeq->getncol();
+
+    LIA ** ARecvSizes = SpHelper::allocate2D<LIA>(UDERA::esscount, stages);
+    LIB ** BRecvSizes = SpHelper::allocate2D<LIB>(UDERB::esscount, stages);
+
+	SpParHelper::GetSetSizes( *(A.spSeq), ARecvSizes, (A.commGrid)->GetRowWorld());
+	SpParHelper::GetSetSizes( *(B.spSeq), BRecvSizes, (B.commGrid)->GetColWorld());
+
+	UDERA * ARecv;
+	UDERB * BRecv;
+	std::vector< SpTuples<LIC,NUO>  *> tomerge;
+
+	int Aself = (A.commGrid)->GetRankInProcRow();
+	int Bself = (B.commGrid)->GetRankInProcCol();
+
+	for(int i = 0; i < stages; ++i)
+	{
+		std::vector<LIA> ess;
+		if(i == Aself)
+		{
+			ARecv = A.spSeq;	// shallow-copy
+		}
+		else
+		{
+			ess.resize(UDERA::esscount);
+			for(int j=0; j< UDERA::esscount; ++j)
+			{
+				ess[j] = ARecvSizes[j][i];		// essentials of the ith matrix in this row
+			}
+			ARecv = new UDERA();				// first, create the object
+		}
+		SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);	// then, receive its elements
+		ess.clear();
+
+		if(i == Bself)
+		{
+			BRecv = B.spSeq;	// shallow-copy
+		}
+		else
+		{
+			ess.resize(UDERB::esscount);
+			for(int j=0; j< UDERB::esscount; ++j)
+			{
+				ess[j] = BRecvSizes[j][i];
+			}
+			BRecv = new UDERB();
+		}
+		SpParHelper::BCastMatrix(GridC->GetColWorld(), *BRecv, ess, i);	// then, receive its elements
+
+		SpTuples<LIC,NUO> * C_cont = LocalSpGEMMMasked<SR, NUO>
+						(*ARecv, *BRecv, *(M.spSeq), complement,
+						i != Aself, 	// 'delete A' condition
+						i != Bself);	// 'delete B' condition
+
+		if(!C_cont->isZero())
+			tomerge.push_back(C_cont);
+		else
+			delete C_cont;
+	}
+
+	if(clearA)
+		A.FreeMemory();
+	if(clearB)
+		B.FreeMemory();
+
+	SpHelper::deallocate2D(ARecvSizes, UDERA::esscount);
+	SpHelper::deallocate2D(BRecvSizes, UDERB::esscount);
+
+    SpTuples<LIC,NUO> * C_tuples = MultiwayMerge<SR>(tomerge, C_m, C_n,true); // Last parameter to delete input tuples
+    UDERO * C = new UDERO(*C_tuples, false); // Last parameter to prevent transpose
+    delete C_tuples;
+
+	return SpParMat<IU,NUO,UDERO> (C, GridC);		// return the result object
+}
+
     
 /**
   * Estimate the maximum nnz needed to store in a process from all stages of SUMMA before reduction
+  * @param[in] hashEstimate {if true, the symbolic multiplication uses hashing, otherwise a heap}
   * @pre { Input matrices, A and B, should not alias }
   **/
 template <typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
@@ -1772,13 +2081,25 @@ int64_t EstPerProcessNnzSUMMA(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB>
     	    // no need to keep entries of colnnzC in larger precision 
 	        // because colnnzC is of length nzc and estimates nnzs per column
 			// @OGUZ-EDIT Using hash spgemm for estimation
-            //LIB * colnnzC = estimateNNZ(*ARecv, *BRecv);
-			LIB* flopC = estimateFLOP(*ARecv, *BRecv);
-			LIB* colnnzC = estimateNNZ_Hash(*ARecv, *BRecv, flopC);
-            LIB nzc = BRecv->GetDCSC()->nzc;
-
-            if (flopC) delete [] flopC;
-            if(colnnzC) delete [] colnnzC;
+            LIB * colnnzC = NULL;
+            if(hashEstimate)
+            {
+                LIB* flopC = estimateFLOP(*ARecv, *BRecv);
+                colnnzC = estimateNNZ_Hash(*ARecv, *BRecv, flopC);
+                if (flopC) delete [] flopC;
+            }
+            else
+            {
+                colnnzC = estimateNNZ(*ARecv, *BRecv);
+            }
+            
+            if(colnnzC)
+            {
+                LIB nzc = BRecv->GetDCSC()->nzc;
+                for (LIB k=0; k<nzc; k++)
+                    nnzC_SUMMA += colnnzC[k];
+                delete [] colnnzC;
+            }
 
 			// sampling-based estimation (comment the estimation above, and
 			// comment out below to use)			
@@ -2213,6 +2534,12 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
     {
         accnz = trxlocnz;
         indacc = trxinds;   // aliasing ptr
+        if(indexisvalue)    // trxnums was never allocated, fill numerical values from indices (see AllGatherVector)
+        {
+            trxnums = new IVT[trxlocnz];
+            for(int i=0; i< trxlocnz; ++i)
+                trxnums[i] = trxinds[i] + lenuntil;
+        }
         numacc = trxnums;   // aliasing ptr
     }
 	
@@ -2287,14 +2614,14 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
 #endif
 	if(optbuf.totmax > 0 )	// graph500 optimization enabled
 	{
-		MPI_Alltoallv(optbuf.inds, sendcnt, optbuf.dspls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);
-		MPI_Alltoallv(optbuf.nums, sendcnt, optbuf.dspls, MPIType<OVT>(), recvnumbuf, recvcnt, rdispls, MPIType<OVT>(), RowWorld);
+		SpParHelper::Alltoallv(optbuf.inds, sendcnt, optbuf.dspls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);
+		SpParHelper::Alltoallv(optbuf.nums, sendcnt, optbuf.dspls, MPIType<OVT>(), recvnumbuf, recvcnt, rdispls, MPIType<OVT>(), RowWorld);
 		delete [] sendcnt;
 	}
 	else
     {
-		MPI_Alltoallv(sendindbuf, sendcnt, sdispls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);
-		MPI_Alltoallv(sendnumbuf, sendcnt, sdispls, MPIType<OVT>(), recvnumbuf, recvcnt, rdispls, MPIType<OVT>(), RowWorld);
+		SpParHelper::Alltoallv(sendindbuf, sendcnt, sdispls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);
+		SpParHelper::Alltoallv(sendnumbuf, sendcnt, sdispls, MPIType<OVT>(), recvnumbuf, recvcnt, rdispls, MPIType<OVT>(), RowWorld);
 		DeleteAll(sendindbuf, sendnumbuf, sendcnt, sdispls);
 	}
 #ifdef TIMING
@@ -2359,6 +2686,423 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
 }
 
 
+/**
+ * Sparse matrix X sparse vector with a persistent workspace (see SpMSpVContext)
+ * Same algorithm and result as SpMV(A, x, y, indexisvalue, SPA), but all temporary buffers,
+ * including the output vector y, are reused across calls instead of being allocated and freed each time.
+ * Input (x) and output (y) vectors can be ALIASED because x is copied out before y is touched.
+ **/
+template <typename SR, typename IVT, typename OVT, typename IU, typename NUM, typename UDER>
+void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, FullyDistSpVec<IU,OVT> & y,
+		   bool indexisvalue, SpMSpVContext<IVT,OVT> & ctx)
+{
+	CheckSpMVCompliance(A,x);
+	y.glen = A.getnrow(); // in case it is not set already
+
+	MPI_Comm World = x.commGrid->GetWorld();
+	MPI_Comm ColWorld = x.commGrid->GetColWorld();
+	MPI_Comm RowWorld = x.commGrid->GetRowWorld();
+
+	// Step 1: transpose x (see TransposeVector)
+	int32_t xlocnz = (int32_t) x.getlocnnz();
+	int32_t roffst = (int32_t) x.RowLenUntil();
+	int32_t roffset, trxlocnz;
+	IU luntil = x.LengthUntil();
+	IU lenuntil;
+	int diagneigh = x.commGrid->GetComplementRank();
+	MPI_Status status;
+	MPI_Sendrecv(&roffst, 1, MPIType<int32_t>(), diagneigh, TROST, &roffset, 1, MPIType<int32_t>(), diagneigh, TROST, World, &status);
+	MPI_Sendrecv(&xlocnz, 1, MPIType<int32_t>(), diagneigh, TRNNZ, &trxlocnz, 1, MPIType<int32_t>(), diagneigh, TRNNZ, World, &status);
+	MPI_Sendrecv(&luntil, 1, MPIType<IU>(), diagneigh, TRLUT, &lenuntil, 1, MPIType<IU>(), diagneigh, TRLUT, World, &status);
+
+	ctx.Grow(ctx.xinds, xlocnz);
+	ctx.Grow(ctx.trxinds, trxlocnz);
+#ifdef THREADED
+#pragma omp parallel for
+#endif
+	for(int i=0; i< xlocnz; ++i)
+		ctx.xinds[i] = (int32_t) x.ind[i];
+	MPI_Sendrecv(ctx.xinds.data(), xlocnz, MPIType<int32_t>(), diagneigh, TRI, ctx.trxinds.data(), trxlocnz, MPIType<int32_t>(), diagneigh, TRI, World, &status);
+	if(!indexisvalue)
+	{
+		ctx.Grow(ctx.trxnums, trxlocnz);
+		MPI_Sendrecv(const_cast<IVT*>(SpHelper::p2a(x.num)), xlocnz, MPIType<IVT>(), diagneigh, TRX, ctx.trxnums.data(), trxlocnz, MPIType<IVT>(), diagneigh, TRX, World, &status);
+	}
+	std::transform(ctx.trxinds.begin(), ctx.trxinds.end(), ctx.trxinds.begin(), [roffset](int32_t  val){return val + roffset;});
+
+	// Step 2: gather x along the processor column (see AllGatherVector)
+	int colneighs, colrank;
+	MPI_Comm_size(ColWorld, &colneighs);
+	MPI_Comm_rank(ColWorld, &colrank);
+	const int32_t * indacc = ctx.trxinds.data();
+	const IVT * numacc = ctx.trxnums.data();
+	int accnz = trxlocnz;
+	IU lenuntilcol = lenuntil;
+	if(colneighs > 1)
+	{
+		ctx.Grow(ctx.colnz, colneighs);
+		ctx.Grow(ctx.coldpls, colneighs);
+		ctx.colnz[colrank] = trxlocnz;
+		MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, ctx.colnz.data(), 1, MPI_INT, ColWorld);
+		ctx.coldpls[0] = 0;
+		std::partial_sum(ctx.colnz.begin(), ctx.colnz.end()-1, ctx.coldpls.begin()+1);
+		accnz = std::accumulate(ctx.colnz.begin(), ctx.colnz.end(), 0);
+		ctx.Grow(ctx.indacc, accnz);
+		MPI_Allgatherv(ctx.trxinds.data(), trxlocnz, MPIType<int32_t>(), ctx.indacc.data(), ctx.colnz.data(), ctx.coldpls.data(), MPIType<int32_t>(), ColWorld);
+		ctx.Grow(ctx.numacc, accnz);
+		if(indexisvalue)
+			MPI_Bcast(&lenuntilcol, 1, MPIType<IU>(), 0, ColWorld);
+		else
+			MPI_Allgatherv(ctx.trxnums.data(), trxlocnz, MPIType<IVT>(), ctx.numacc.data(), ctx.colnz.data(), ctx.coldpls.data(), MPIType<IVT>(), ColWorld);
+		indacc = ctx.indacc.data();
+		numacc = ctx.numacc.data();
+	}
+	if(indexisvalue)	// fill numerical values from indices
+	{
+		ctx.Grow(ctx.numacc, accnz);
+		for(int i=0; i< accnz; ++i)
+			ctx.numacc[i] = indacc[i] + lenuntilcol;
+		numacc = ctx.numacc.data();
+	}
+
+	// Step 3: local multiplication into ctx.indy/numy, sorted by local row index
+	int32_t nlocrows = static_cast<int32_t>(A.getlocalrows());
+	int splits = A.seq().getnsplit();
+	ctx.indy.clear();
+	ctx.numy.clear();
+	if(A.getlocalnnz() > 0 && accnz > 0)
+	{
+		if(splits > 0)
+		{
+			if((int) ctx.splitinds.size() < splits)
+			{
+				ctx.splitinds.resize(splits);
+				ctx.splitnums.resize(splits);
+			}
+			int32_t perpiece = nlocrows / splits;
+#ifdef THREADED
+#pragma omp parallel for
+#endif
+			for(int i=0; i<splits; ++i)
+			{
+				ctx.splitinds[i].clear();
+				ctx.splitnums[i].clear();
+				int32_t mA = (i != splits-1) ? perpiece : nlocrows - perpiece*i;
+				if(ctx.SPA.initialized)
+					SpMXSpV_ForThreading<SR>(*(A.seq().GetInternal(i)), mA, indacc, numacc, accnz, ctx.splitinds[i], ctx.splitnums[i], i*perpiece, ctx.SPA.V_localy[i], ctx.SPA.V_isthere[i], ctx.SPA.V_inds[i]);
+				else
+					SpMXSpV_ForThreading<SR>(*(A.seq().GetInternal(i)), mA, indacc, numacc, accnz, ctx.splitinds[i], ctx.splitnums[i], i*perpiece);
+			}
+			ctx.Grow(ctx.splitdispls, splits+1);
+			ctx.splitdispls[0] = 0;
+			for(int i=0; i<splits; ++i)
+				ctx.splitdispls[i+1] = ctx.splitdispls[i] + ctx.splitinds[i].size();
+			ctx.Grow(ctx.indy, ctx.splitdispls[splits]);
+			ctx.Grow(ctx.numy, ctx.splitdispls[splits]);
+#ifdef THREADED
+#pragma omp parallel for
+#endif
+			for(int i=0; i<splits; ++i)
+			{
+				std::copy(ctx.splitinds[i].begin(), ctx.splitinds[i].end(), ctx.indy.begin() + ctx.splitdispls[i]);
+				std::copy(ctx.splitnums[i].begin(), ctx.splitnums[i].end(), ctx.numy.begin() + ctx.splitdispls[i]);
+			}
+		}
+		else
+		{
+			generic_gespmv<SR>(A.seq(), indacc, numacc, static_cast<int32_t>(accnz), ctx.indy, ctx.numy, ctx.SPA);
+		}
+	}
+
+	// Step 4: partition the sorted local output among the processor row (same boundaries as LocalSpMV)
+	int rowneighs;
+	MPI_Comm_size(RowWorld, &rowneighs);
+	int32_t bufsize = ctx.indy.size();
+	int32_t perproc = nlocrows / rowneighs;
+	ctx.Grow(ctx.sendcnt, rowneighs);
+	ctx.Grow(ctx.sdispls, rowneighs);
+	for(int i=0; i<rowneighs; ++i)
+	{
+		int32_t beg_this = (i==0) ? 0 : i*perproc;
+		ctx.sdispls[i] = std::lower_bound(ctx.indy.begin(), ctx.indy.end(), beg_this) - ctx.indy.begin();
+	}
+	for(int i=0; i<rowneighs; ++i)
+		ctx.sendcnt[i] = ((i==rowneighs-1) ? bufsize : ctx.sdispls[i+1]) - ctx.sdispls[i];
+#ifdef THREADED
+#pragma omp parallel for
+#endif
+	for(int i=0; i<rowneighs; ++i)
+	{
+		int32_t offset = i*perproc;	// convert to receiver's local index
+		for(int k = ctx.sdispls[i]; k < ctx.sdispls[i] + ctx.sendcnt[i]; ++k)
+			ctx.indy[k] -= offset;
+	}
+
+	if(rowneighs == 1)
+	{
+		y.ind.assign(ctx.indy.begin(), ctx.indy.end());
+		y.num.assign(ctx.numy.begin(), ctx.numy.end());
+		return;
+	}
+
+	// Step 5: exchange and merge the partial results
+	ctx.Grow(ctx.recvcnt, rowneighs);
+	ctx.Grow(ctx.rdispls, rowneighs);
+	MPI_Alltoall(ctx.sendcnt.data(), 1, MPI_INT, ctx.recvcnt.data(), 1, MPI_INT, RowWorld);
+	ctx.rdispls[0] = 0;
+	std::partial_sum(ctx.recvcnt.begin(), ctx.recvcnt.end()-1, ctx.rdispls.begin()+1);
+	int totrecv = std::accumulate(ctx.recvcnt.begin(), ctx.recvcnt.end(), 0);
+	ctx.Grow(ctx.recvindbuf, totrecv);
+	ctx.Grow(ctx.recvnumbuf, totrecv);
+	SpParHelper::Alltoallv(ctx.indy.data(), ctx.sendcnt.data(), ctx.sdispls.data(), MPIType<int32_t>(), ctx.recvindbuf.data(), ctx.recvcnt.data(), ctx.rdispls.data(), MPIType<int32_t>(), RowWorld);
+	SpParHelper::Alltoallv(ctx.numy.data(), ctx.sendcnt.data(), ctx.sdispls.data(), MPIType<OVT>(), ctx.recvnumbuf.data(), ctx.recvcnt.data(), ctx.rdispls.data(), MPIType<OVT>(), RowWorld);
+
+	y.ind.clear();	// keeps the capacity of y from the previous call
+	y.num.clear();
+	ctx.Grow(ctx.indsvec, rowneighs);
+	ctx.Grow(ctx.numsvec, rowneighs);
+	for(int i=0; i<rowneighs; i++)
+	{
+		ctx.indsvec[i] = ctx.recvindbuf.data()+ctx.rdispls[i];
+		ctx.numsvec[i] = ctx.recvnumbuf.data()+ctx.rdispls[i];
+	}
+	int * listSizes = ctx.recvcnt.data();
+#ifdef THREADED
+	MergeContributions_threaded<SR>(listSizes, ctx.indsvec, ctx.numsvec, y.ind, y.num, y.MyLocLength());
+#else
+	MergeContributions<SR>(listSizes, ctx.indsvec, ctx.numsvec, y.ind, y.num);
+#endif
+}
+
+
+/**
+ * Persistent state of the direction-optimizing SpMSpV (see the masked SpMV below) for a fixed matrix A
+ * Holds the local transposes of A's blocks for row-wise (pull) access, the row and column degrees
+ * of A for the switching heuristic, and the current direction.
+ * Switching follows Beamer et al.: go from push to pull when the edges out of the frontier exceed
+ * 1/alpha of the edges into the active rows, go back to push when the frontier falls below n/beta
+ **/
+template <typename IU, typename NUM, typename UDER>
+class SpMSpVDirOpt
+{
+public:
+	SpMSpVDirOpt(const SpParMat<IU,NUM,UDER> & A, double alpha = 14, double beta = 24):
+	rowDegrees(A.getcommgrid()), colDegrees(A.getcommgrid()), alpha(alpha), beta(beta), pull(false), pushSteps(0), pullSteps(0)
+	{
+		localT = A.seq().TransposeConstPtr();
+		A.Reduce(rowDegrees, Row, std::plus<IU>(), static_cast<IU>(0), [](NUM){ return static_cast<IU>(1); });
+		A.Reduce(colDegrees, Column, std::plus<IU>(), static_cast<IU>(0), [](NUM){ return static_cast<IU>(1); });
+	}
+	~SpMSpVDirOpt() { delete localT; }
+	SpMSpVDirOpt(const SpMSpVDirOpt & rhs) = delete;
+	SpMSpVDirOpt & operator=(const SpMSpVDirOpt & rhs) = delete;
+
+	UDER * localT;			// transpose of the local block of A, i.e., its rows as columns
+	FullyDistVec<IU,IU> rowDegrees;
+	FullyDistVec<IU,IU> colDegrees;
+	double alpha;
+	double beta;
+	bool pull;			// direction of the last step
+	int pushSteps;
+	int pullSteps;
+};
+
+/**
+ * Direction-optimizing masked sparse matrix X sparse vector for general semirings
+ * y(i) = sum_j A(i,j)*x(j) over the semiring SR, computed only for the active rows i, i.e., those with isActive(mask(i)) == true
+ * (e.g., the unvisited vertices of a BFS-like traversal). Each call decides between
+ *   push: the regular SpMSpV, driven by the nonzeros of x, whose output is then masked
+ *   pull: a row-wise traversal of the active rows of A (using dirOpt.localT) against a dense copy of x
+ * The pull step does not stop early on the first contribution, hence it is exact for any semiring.
+ * Input (x) and output (y) vectors can be ALIASED.
+ * @pre { dirOpt was constructed from A, whose local blocks are not split, and mask has the length of y }
+ **/
+template <typename SR, typename IVT, typename OVT, typename IU, typename NUM, typename UDER, typename MT, typename _UnaryPredicate>
+void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, FullyDistSpVec<IU,OVT> & y,
+		   const FullyDistVec<IU,MT> & mask, _UnaryPredicate isActive, SpMSpVDirOpt<IU,NUM,UDER> & dirOpt)
+{
+	CheckSpMVCompliance(A,x);
+	MPI_Comm World = x.commGrid->GetWorld();
+	MPI_Comm ColWorld = x.commGrid->GetColWorld();
+	MPI_Comm RowWorld = x.commGrid->GetRowWorld();
+
+	// switching heuristic: edges out of the frontier (mf), edges into active rows (mu), frontier size (nf)
+	const MT * maskarr = mask.GetLocArr();
+	IU masklocnz = mask.LocArrSize();
+	const IU * coldeg = dirOpt.colDegrees.GetLocArr();
+	const IU * rowdeg = dirOpt.rowDegrees.GetLocArr();
+	int64_t mf = 0, mu = 0;
+	for(IU k=0; k< x.getlocnnz(); ++k)
+		mf += coldeg[x.ind[k]];
+#ifdef THREADED
+#pragma omp parallel for reduction(+:mu)
+#endif
+	for(IU i=0; i< masklocnz; ++i)
+	{
+		if(isActive(maskarr[i]))	mu += rowdeg[i];
+	}
+	int64_t counts[3] = {mf, mu, static_cast<int64_t>(x.getlocnnz())};
+	MPI_Allreduce(MPI_IN_PLACE, counts, 3, MPIType<int64_t>(), MPI_SUM, World);
+	if(!dirOpt.pull && static_cast<double>(counts[0]) > static_cast<double>(counts[1]) / dirOpt.alpha)
+		dirOpt.pull = true;
+	else if(dirOpt.pull && static_cast<double>(counts[2]) < static_cast<double>(A.getncol()) / dirOpt.beta)
+		dirOpt.pull = false;
+
+	if(!dirOpt.pull)
+	{
+		++dirOpt.pushSteps;
+		SpMV<SR>(A, x, y, false);
+		IU k = 0;	// mask the output in place
+		for(IU i=0; i< y.getlocnnz(); ++i)
+		{
+			if(isActive(maskarr[y.ind[i]]))
+			{
+				y.ind[k] = y.ind[i];
+				y.num[k++] = y.num[i];
+			}
+		}
+		y.ind.resize(k);
+		y.num.resize(k);
+		return;
+	}
+	++dirOpt.pullSteps;
+
+	// dense copy of x for the local columns of A
+	int accnz;
+	int32_t trxlocnz;
+	IU lenuntil;
+	int32_t *trxinds, *indacc;
+	IVT *trxnums, *numacc;
+	TransposeVector(World, x, trxlocnz, lenuntil, trxinds, trxnums, false);
+	if(x.commGrid->GetGridRows() > 1)
+	{
+		AllGatherVector(ColWorld, trxlocnz, lenuntil, trxinds, trxnums, indacc, numacc, accnz, false);
+	}
+	else
+	{
+		accnz = trxlocnz;
+		indacc = trxinds;
+		numacc = trxnums;
+	}
+	IU nlocalcols = A.getlocalcols();
+	std::vector<char> xset(nlocalcols, 0);
+	std::vector<IVT> xval(nlocalcols);
+	for(int k=0; k< accnz; ++k)
+	{
+		xset[indacc[k]] = 1;
+		xval[indacc[k]] = numacc[k];
+	}
+	DeleteAll(indacc, numacc);
+
+	// active flags of the local rows of A, gathered from the mask pieces along the processor row
+	int rowneighs, rowrank;
+	MPI_Comm_size(RowWorld, &rowneighs);
+	MPI_Comm_rank(RowWorld, &rowrank);
+	std::vector<int> rowcnt(rowneighs), rowdspl(rowneighs, 0);
+	rowcnt[rowrank] = static_cast<int>(masklocnz);
+	MPI_Allgather(MPI_IN_PLACE, 1, MPI_INT, rowcnt.data(), 1, MPI_INT, RowWorld);
+	std::partial_sum(rowcnt.begin(), rowcnt.end()-1, rowdspl.begin()+1);
+	IU nlocalrows = A.getlocalrows();
+	std::vector<char> rowactive(nlocalrows);
+	for(IU i=0; i< masklocnz; ++i)
+		rowactive[rowdspl[rowrank] + i] = isActive(maskarr[i]) ? 1 : 0;
+	MPI_Allgatherv(MPI_IN_PLACE, rowcnt[rowrank], MPI_CHAR, rowactive.data(), rowcnt.data(), rowdspl.data(), MPI_CHAR, RowWorld);
+
+	// pull: rows of A are the columns of its local transpose, hence they come out sorted
+	std::vector<int32_t> indy;
+	std::vector<OVT> numy;
+	if(dirOpt.localT->getnnz() > 0)
+	{
+		auto * T = dirOpt.localT->GetDCSC();
+		int nsplits = 1;
+#ifdef THREADED
+#pragma omp parallel
+		{
+			nsplits = 4*omp_get_num_threads();
+		}
+#endif
+		nsplits = std::max(1, static_cast<int>(std::min<IU>(nsplits, T->nzc)));
+		std::vector< std::vector<int32_t> > splitinds(nsplits);
+		std::vector< std::vector<OVT> > splitnums(nsplits);
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for(int s=0; s< nsplits; ++s)
+		{
+			IU beg = (T->nzc / nsplits) * s;
+			IU end = (s == nsplits-1) ? T->nzc : (T->nzc / nsplits) * (s+1);
+			for(IU k = beg; k < end; ++k)
+			{
+				IU row = T->jc[k];
+				if(!rowactive[row]) continue;
+				bool found = false;
+				OVT acc = OVT();
+				for(IU p = T->cp[k]; p < T->cp[k+1]; ++p)
+				{
+					IU col = T->ir[p];
+					if(!xset[col]) continue;
+					OVT mrhs = SR::multiply(T->numx[p], xval[col]);
+					acc = found ? SR::add(acc, mrhs) : mrhs;
+					found = true;
+				}
+				if(found)
+				{
+					splitinds[s].push_back(static_cast<int32_t>(row));
+					splitnums[s].push_back(acc);
+				}
+			}
+		}
+		for(int s=0; s< nsplits; ++s)
+		{
+			indy.insert(indy.end(), splitinds[s].begin(), splitinds[s].end());
+			numy.insert(numy.end(), splitnums[s].begin(), splitnums[s].end());
+		}
+	}
+
+	// same distribution of the partial results as the push path (see LocalSpMV)
+	y.glen = A.getnrow();
+	int32_t perproc = nlocalrows / rowneighs;
+	std::vector<int> sendcnt(rowneighs, 0), sdispls(rowneighs, 0);
+	for(size_t k=0; k< indy.size(); ++k)
+	{
+		int owner = (perproc > 0) ? std::min(static_cast<int>(indy[k] / perproc), rowneighs-1) : rowneighs-1;
+		indy[k] -= owner*perproc;
+		++sendcnt[owner];
+	}
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	if(rowneighs == 1)
+	{
+		y.ind.assign(indy.begin(), indy.end());
+		y.num.swap(numy);
+		return;
+	}
+	std::vector<int> recvcnt(rowneighs), rdispls(rowneighs, 0);
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, RowWorld);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	int totrecv = std::accumulate(recvcnt.begin(), recvcnt.end(), 0);
+	std::vector<int32_t> recvindbuf(totrecv);
+	std::vector<OVT> recvnumbuf(totrecv);
+	SpParHelper::Alltoallv(indy.data(), sendcnt.data(), sdispls.data(), MPIType<int32_t>(), recvindbuf.data(), recvcnt.data(), rdispls.data(), MPIType<int32_t>(), RowWorld);
+	SpParHelper::Alltoallv(numy.data(), sendcnt.data(), sdispls.data(), MPIType<OVT>(), recvnumbuf.data(), recvcnt.data(), rdispls.data(), MPIType<OVT>(), RowWorld);
+
+	std::vector<IU>().swap(y.ind);
+	std::vector<OVT>().swap(y.num);
+	std::vector<int32_t *> indsvec(rowneighs);
+	std::vector<OVT *> numsvec(rowneighs);
+	for(int i=0; i<rowneighs; i++)
+	{
+		indsvec[i] = recvindbuf.data()+rdispls[i];
+		numsvec[i] = recvnumbuf.data()+rdispls[i];
+	}
+	int * listSizes = recvcnt.data();
+#ifdef THREADED
+	MergeContributions_threaded<SR>(listSizes, indsvec, numsvec, y.ind, y.num, y.MyLocLength());
+#else
+	MergeContributions<SR>(listSizes, indsvec, numsvec, y.ind, y.num);
+#endif
+}
+
+
 /**
  * Automatic type promotion is ONLY done here, all the callee functions (in Friends.h and below) are initialized with the promoted type
  * If indexisvalues = true, then we do not need to transfer values for x (happens for BFS iterations with boolean matrices and integer rhs vectors)
@@ -2563,8 +3307,8 @@ FullyDistSpVec<IU,typename promote_trait<NUM,NUV>::T_promote>  SpMV
     std::copy(sendnum[i].begin(), sendnum[i].end(), sendnumbuf+sdispls[i]);
 		std::vector<T_promote>().swap(sendnum[i]);
 	}
-	MPI_Alltoallv(sendindbuf, sendcnt, sdispls, MPIType<IU>(), recvindbuf, recvcnt, rdispls, MPIType<IU>(), RowWorld);
-	MPI_Alltoallv(sendnumbuf, sendcnt, sdispls, MPIType<T_promote>(), recvnumbuf, recvcnt, rdispls, MPIType<T_promote>(), RowWorld);
+	SpParHelper::Alltoallv(sendindbuf, sendcnt, sdispls, MPIType<IU>(), recvindbuf, recvcnt, rdispls, MPIType<IU>(), RowWorld);
+	SpParHelper::Alltoallv(sendnumbuf, sendcnt, sdispls, MPIType<T_promote>(), recvnumbuf, recvcnt, rdispls, MPIType<T_promote>(), RowWorld);
 	
 	DeleteAll(sendindbuf, sendnumbuf);
 	DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
@@ -3609,7 +4353,7 @@ SpParMat3D<IU,NUO,UDERO> Mult_AnXBn_SUMMA3D(SpParMat3D<IU,NU1,UDER1> & A, SpParM
 #ifdef TIMING
     t2 = MPI_Wtime();
 #endif
-    MPI_Alltoallv(C_tuples->tuples, sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, A.getcommgrid3D()->GetFiberWorld());
+    SpParHelper::Alltoallv(C_tuples->tuples, sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, A.getcommgrid3D()->GetFiberWorld());
     delete C_tuples;
 #ifdef TIMING
     t3 = MPI_Wtime();
@@ -3668,7 +4412,7 @@ SpParMat3D<IU,NUO,UDERO> Mult_AnXBn_SUMMA3D(SpParMat3D<IU,NU1,UDER1> & A, SpParM
 
 /*
  * Parameters:
- *  - computationKernel: 1 for hash-based, 2 for heap-based
+ *  - computationKernel: 0 for per-column selection, 1 for hash-based, 2 for heap-based
  * */
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
 SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A, SpParMat3D<IU, NU2, UDERB> & B,
@@ -3704,9 +4448,10 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
 #endif
     /* 
      * If per process memory is provided then calculate number of phases 
+     * (negative: use the memory available on the node) 
      * Otherwise, proceed to multiplication.
      * */
-    if(perProcessMemory > 0) {
+    if(perProcessMemory != 0) {
         int p, calculatedPhases;
         MPI_Comm_size(A.getcommgrid3D()->GetLayerWorld(),&p);
         int64_t perNNZMem_in = sizeof(IU)*2 + sizeof(NU1);
@@ -3735,7 +4480,8 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
         //estimate output memory
         int64_t postKselectOutputNNZ = ceil(( (B.GetLayerMat()->getlocalcols() / B.getcommgrid3D()->GetGridLayers() ) * k)/sqrt(p)); // If kselect is run
         int64_t postKselectOutputMem = postKselectOutputNNZ * perNNZMem_out * 2;
-        double remainingMem = perProcessMemory*1000000000 - ginputMem - postKselectOutputMem;
+        int64_t memoryBudget = (perProcessMemory > 0) ? perProcessMemory*1000000000 : SpParHelper::AvailableMemory(A.getcommgrid3D()->GetWorld()) + gannz * perNNZMem_in * 2;
+        double remainingMem = memoryBudget - ginputMem - postKselectOutputMem;
         int64_t kselectMem = B.GetLayerMat()->getlocalcols() * k * sizeof(NUO) * 3;
 
         //inputMem + outputMem + asquareMem/phases + kselectmem/phases < memory
@@ -3920,7 +4666,13 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
 #endif
             SpTuples<LIC,NUO> * C_cont;
             
-            if(computationKernel == 1){
+            if(computationKernel == 0){
+                C_cont = LocalAdaptiveSpGEMM<SR, NUO>
+                                    (*ARecv, *BRecv,    // parameters themselves
+                                    false,         // 'delete A' condition
+                                    false);        // 'delete B' condition
+            }
+            else if(computationKernel == 1){
                 C_cont = LocalSpGEMMHash<SR, NUO>
                                     (*ARecv, *BRecv,    // parameters themselves
                                     false,         // 'delete A' condition
@@ -3953,7 +4705,7 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
         t2 = MPI_Wtime();
 #endif
         SpTuples<LIC,NUO> * C_tuples;
-        if(computationKernel == 1) C_tuples = MultiwayMergeHash<SR>(tomerge, C_m, C_n, true, true); // Delete input arrays and sort
+        if(computationKernel == 0 || computationKernel == 1) C_tuples = MultiwayMergeHash<SR>(tomerge, C_m, C_n, true, true); // Delete input arrays and sort
         else if(computationKernel == 2) C_tuples = MultiwayMerge<SR>(tomerge, C_m, C_n, true); // Delete input arrays and sort
         
 #ifdef TIMING
@@ -4072,7 +4824,7 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
 #ifdef TIMING
         t2 = MPI_Wtime();
 #endif
-        MPI_Alltoallv(C_tuples->tuples, sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, A.getcommgrid3D()->GetFiberWorld());
+        SpParHelper::Alltoallv(C_tuples->tuples, sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, A.getcommgrid3D()->GetFiberWorld());
         delete C_tuples;
 #ifdef TIMING
         t3 = MPI_Wtime();
@@ -4119,7 +4871,7 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
          * */
         SpTuples<LIC, NUO> * merged_tuples;
 
-        if(computationKernel == 1) merged_tuples = MultiwayMergeHash<SR, LIC, NUO>(recvChunks, recvChunks[0]->getnrow(), recvChunks[0]->getncol(), false, false); // Do not delete
+        if(computationKernel == 0 || computationKernel == 1) merged_tuples = MultiwayMergeHash<SR, LIC, NUO>(recvChunks, recvChunks[0]->getnrow(), recvChunks[0]->getncol(), false, false); // Do not delete
         else if(computationKernel == 2) merged_tuples = MultiwayMerge<SR, LIC, NUO>(recvChunks, recvChunks[0]->getnrow(), recvChunks[0]->getncol(), false); // Do not delete
 #ifdef TIMING
         t1 = MPI_Wtime();
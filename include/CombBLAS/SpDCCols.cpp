@@ -62,6 +62,20 @@ SpDCCols<IT,NT>::SpDCCols(IT size, IT nRow, IT nCol, IT nzc)
 		dcsc = NULL; 
 }
 
+/**
+ * Wraps existing DCSC arrays (e.g. in a memory mapped file) without copying them; they are not freed by this object,
+ * and operations that need to reallocate them copy them into owned memory first
+ */
+template <class IT, class NT>
+SpDCCols<IT,NT>::SpDCCols(IT nRow, IT nCol, IT size, IT nzc, IT * cp, IT * jc, IT * ir, NT * numx)
+:m(nRow), n(nCol), nnz(size), splits(0)
+{
+	if(nnz > 0)
+		dcsc = new Dcsc<IT,NT>(cp, jc, ir, numx, nnz, nzc, false);
+	else
+		dcsc = NULL; 
+}
+
 template <class IT, class NT>
 SpDCCols<IT,NT>::~SpDCCols()
 {
@@ -59,6 +59,7 @@ public:
 	SpDCCols (IT size, IT nRow, IT nCol, IT nzc);
 	SpDCCols (const SpTuples<IT,NT> & rhs, bool transpose);
     SpDCCols (IT nRow, IT nCol, IT nnz1, const std::tuple<IT, IT, NT> * rhs, bool transpose);
+	SpDCCols (IT nRow, IT nCol, IT size, IT nzc, IT * cp, IT * jc, IT * ir, NT * numx);	//!< Wraps DCSC arrays that stay owned by the caller
 
 	SpDCCols (const SpDCCols<IT,NT> & rhs);					// Actual copy constructor		
 	~SpDCCols();
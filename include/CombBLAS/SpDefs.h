@@ -87,6 +87,7 @@ namespace combblas {
 //	TR: Transpose
 //	RD: ReadDistribute
 //	RF: Sparse matrix indexing
+//	A2A: Alltoallv layer (SpParHelper::Alltoallv)
 #define TRTAGNZ 121
 #define TRTAGM 122
 #define TRTAGN 123
@@ -109,6 +110,7 @@ namespace combblas {
 #define ROTATE 140
 #define PUPSIZE 141
 #define PUPDATA 142
+#define A2ATAG 143
 
 enum Dim
 {
@@ -116,6 +118,15 @@ Column,
 Row
 };
 
+// Algorithms of SpParHelper::Alltoallv, can also be set through the COMBBLAS_ALLTOALLV environment variable (auto, direct, sparse, node)
+enum AlltoallvMode
+{
+A2A_AUTO,	// decided per call from the (globally reduced) message statistics
+A2A_DIRECT,	// plain MPI_Alltoallv
+A2A_SPARSE,	// point-to-point messages to/from the nonzero counts only
+A2A_NODE	// two-level: gather on the node leaders, exchange among leaders, scatter back
+};
+
 
 // force 8-bytes alignment in heap allocated memory
 #ifndef ALIGN
@@ -126,6 +137,18 @@ Row
 #define THRESHOLD 4	// if range1.size() / range2.size() < threshold, use scanning based indexing
 #endif
 
+#ifndef A2A_MINRANKS
+#define A2A_MINRANKS 64	// A2A_AUTO always uses MPI_Alltoallv on smaller communicators
+#endif
+
+#ifndef A2A_SPARSEFRACTION
+#define A2A_SPARSEFRACTION 8	// A2A_AUTO goes point-to-point if no rank talks to more than 1/A2A_SPARSEFRACTION of the ranks
+#endif
+
+#ifndef A2A_SMALLMSG
+#define A2A_SMALLMSG 1024	// A2A_AUTO aggregates on nodes if the average message is at most this many bytes
+#endif
+
 #ifndef MEMORYINBYTES
 #define MEMORYINBYTES  (196 * 1048576)	// 196 MB, it is advised to define MEMORYINBYTES to be "at most" (1/4)th of available memory per core
 #endif
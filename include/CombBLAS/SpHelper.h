@@ -36,6 +36,15 @@
 #include <map>
 #include <string>
 #include <utility>
+#include <numeric>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+#include <type_traits>
+#include <algorithm>
+#ifdef COMBBLAS_ZLIB
+#include <zlib.h>
+#endif
 #include "SpDefs.h"
 #include "StackEntry.h"
 #include "promote.h"
@@ -43,6 +52,7 @@
 #include "HeapEntry.h"
 #include "SpImpl.h"
 #include "hash.hpp"
+#include "StringTable.h"
 
 namespace combblas {
 
@@ -90,59 +100,6 @@ public:
         }
     }
     
-    static void ProcessLinesWithStringKeys(std::vector< std::map < std::string, uint64_t> > & allkeys, std::vector<std::string> & lines, int nprocs)
-    {
-    	std::string frstr, tostr;
-    	uint64_t frhash, tohash;    
-    	double vv;
-    	for (auto itr=lines.begin(); itr != lines.end(); ++itr)
-    	{
-		char fr[MAXVERTNAME];
-		char to[MAXVERTNAME];
-		sscanf(itr->c_str(), "%s %s %lg", fr, to, &vv);
-		frstr = std::string(fr);
-		tostr = std::string(to);
-		MurmurHash3_x64_64(frstr.c_str(),frstr.size(),0,&frhash);
-		MurmurHash3_x64_64(tostr.c_str(),tostr.size(),0,&tohash);	
-
-		double range_fr = static_cast<double>(frhash) * static_cast<double>(nprocs);
-		double range_to = static_cast<double>(tohash) * static_cast<double>(nprocs);
-    		size_t owner_fr = range_fr / static_cast<double>(std::numeric_limits<uint64_t>::max());
-    		size_t owner_to = range_to / static_cast<double>(std::numeric_limits<uint64_t>::max());
-
-		// cout << frstr << " with hash " << frhash << " is going to " << owner_fr << endl;
-		// cout << tostr << " with hash " << tohash << " is going to " << owner_to << endl;
-
-		allkeys[owner_fr].insert(std::make_pair(frstr, frhash)); 
-		allkeys[owner_to].insert(std::make_pair(tostr, tohash));
-   	}
-        lines.clear();	
-    }
-
-    template <typename IT1, typename NT1>
-    static void ProcessStrLinesNPermute(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, std::vector<std::string> & lines, std::map<std::string, uint64_t> & ultperm)
-    {
-	char * fr = new char[MAXVERTNAME];
-    	char * to = new char[MAXVERTNAME];
-    	std::string frstr, tostr;
-    	double vv;
-    	for (auto itr=lines.begin(); itr != lines.end(); ++itr)
-    	{
-		sscanf(itr->c_str(), "%s %s %lg", fr, to, &vv);
-		frstr = std::string(fr);
-		tostr = std::string(to);
-	
-		rows.emplace_back((IT1) ultperm[frstr]);
-		cols.emplace_back((IT1) ultperm[tostr]); 
-		vals.emplace_back((NT1) vv);
-   	}
-	delete [] fr;
-	delete [] to;
-        lines.clear();	
-    }
-
-
-
     template <typename IT1, typename NT1>
     static void ProcessLines(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, std::vector<std::string> & lines, int symmetric, int type, bool onebased = true)
     {
@@ -182,6 +139,460 @@ public:
         lines.clear();
     }
 
+    //! Upper bound on the characters FormatNumber writes for any integer or floating point value
+    static const int MAXNUMBERCHARS = 32;
+
+    /**
+     * Writes the decimal text of v at p and returns the position after it (p must have MAXNUMBERCHARS bytes of room)
+     * Integers are written exactly; floating point values in the shortest form that reads back to the same value
+     */
+    template <typename T>
+    static char * FormatNumber(char * p, T v)
+    {
+        if constexpr (std::is_same<T,bool>::value)
+        {
+            *p++ = v ? '1' : '0';
+            return p;
+        }
+        else
+        {
+            return std::to_chars(p, p + MAXNUMBERCHARS, v).ptr;
+        }
+    }
+
+#ifdef COMBBLAS_ZLIB
+    /**
+     * Compresses [in, in+n) into out as one self-contained gzip member
+     * Since a concatenation of gzip members is itself a gzip file, pieces compressed independently can be written back to back
+     */
+    static void GzipCompress(const char * in, size_t n, int level, std::vector<char> & out)
+    {
+        const size_t maxchunk = (1 << 30);    // avail_in and avail_out are 32-bit
+        z_stream strm;
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        deflateInit2(&strm, level, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY);    // windowBits 15+16 asks for the gzip wrapper
+        out.resize(deflateBound(&strm, n));
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+        strm.avail_in = 0;
+        strm.next_out = reinterpret_cast<Bytef*>(out.data());
+        strm.avail_out = 0;
+        size_t inleft = n;
+        size_t outleft = out.size();
+        int ret;
+        do
+        {
+            if(strm.avail_in == 0 && inleft > 0)
+            {
+                strm.avail_in = static_cast<uInt>(std::min(inleft, maxchunk));
+                inleft -= strm.avail_in;
+            }
+            if(strm.avail_out == 0)
+            {
+                if(outleft == 0)    // deflateBound is not supposed to be exceeded, but stay safe
+                {
+                    size_t used = strm.total_out;
+                    out.resize(2*out.size());
+                    outleft = out.size() - used;
+                    strm.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+                }
+                strm.avail_out = static_cast<uInt>(std::min(outleft, maxchunk));
+                outleft -= strm.avail_out;
+            }
+            ret = deflate(&strm, (inleft == 0) ? Z_FINISH : Z_NO_FLUSH);
+        } while(ret != Z_STREAM_END && ret != Z_STREAM_ERROR);
+        out.resize(strm.total_out);
+        deflateEnd(&strm);
+    }
+#endif
+
+    //! Appends v to out as a little-endian base-128 varint (7 bits per byte, high bit set on all but the last byte)
+    static void EncodeVarint(uint64_t v, std::vector<uint8_t> & out)
+    {
+        while(v >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    //! Decodes a varint written by EncodeVarint, returns the position after it
+    static const uint8_t * DecodeVarint(const uint8_t * p, uint64_t & v)
+    {
+        v = 0;
+        int shift = 0;
+        while(*p & 0x80)
+        {
+            v |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        v |= static_cast<uint64_t>(*p++) << shift;
+        return p;
+    }
+
+    //! Skips blanks (but not line breaks) starting at p
+    static const char * SkipBlanks(const char * p)
+    {
+        while(*p == ' ' || *p == '\t' || *p == '\r') ++p;
+        return p;
+    }
+
+    //! Parses a signed decimal integer starting at p (after blanks), returns the position after it or NULL if there is none
+    static const char * ScanInt(const char * p, int64_t & val)
+    {
+        p = SkipBlanks(p);
+        bool neg = (*p == '-');
+        if(*p == '-' || *p == '+') ++p;
+        if(*p < '0' || *p > '9') return NULL;
+        uint64_t v = 0;
+        while(*p >= '0' && *p <= '9')
+            v = v * 10 + (*p++ - '0');
+        val = neg ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+        return p;
+    }
+
+    /**
+     * Parses a floating point number starting at p (after blanks), returns the position after it or NULL if there is none
+     * Numbers with at most 15 significant digits and a decimal exponent within [-22,22] are converted with a single
+     * (correctly rounded) multiplication or division by an exact power of ten; everything else (long mantissas,
+     * large exponents, inf, nan, hex floats) falls back to strtod so the result is always identical to sscanf's
+     * The caller guarantees that the token is followed by a non-numeric character (the line break at the latest)
+     */
+    static const char * ScanReal(const char * p, double & val)
+    {
+        static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        p = SkipBlanks(p);
+        const char * start = p;
+        bool neg = (*p == '-');
+        if(*p == '-' || *p == '+') ++p;
+
+        uint64_t mantissa = 0;
+        int sigdigits = 0;
+        int exp10 = 0;
+        bool anydigit = false;
+        for(; *p >= '0' && *p <= '9'; ++p)
+        {
+            anydigit = true;
+            if(mantissa == 0 && *p == '0') continue;   // leading zeros are not significant
+            if(sigdigits < 19) { mantissa = mantissa * 10 + (*p - '0'); ++sigdigits; }
+            else ++exp10;
+        }
+        if(*p == '.')
+        {
+            for(++p; *p >= '0' && *p <= '9'; ++p)
+            {
+                anydigit = true;
+                if(mantissa == 0 && *p == '0') { --exp10; continue; }
+                if(sigdigits < 19) { mantissa = mantissa * 10 + (*p - '0'); ++sigdigits; --exp10; }
+            }
+        }
+        if(anydigit && (*p == 'e' || *p == 'E'))
+        {
+            int64_t e = 0;
+            const char * q = p+1;
+            if(*q == '-' || *q == '+') ++q;
+            if(*q >= '0' && *q <= '9')
+            {
+                ScanInt(p+1, e);
+                while(*q >= '0' && *q <= '9') ++q;
+                if(e > 100000) e = 100000;  // keep exp10 from overflowing, strtod handles the rest
+                else if(e < -100000) e = -100000;
+                exp10 += static_cast<int>(e);
+                p = q;
+            }
+        }
+        bool hex = (*p == 'x' || *p == 'X');    // scanned the leading 0 of a hex float
+        if(anydigit && !hex && sigdigits <= 15 && exp10 >= -22 && exp10 <= 22)
+        {
+            double v = static_cast<double>(mantissa);
+            v = (exp10 < 0) ? v / pow10[-exp10] : v * pow10[exp10];
+            val = neg ? -v : v;
+            return p;
+        }
+        char * strend;
+        val = strtod(start, &strend);
+        if(strend == start) return NULL;
+        return strend;
+    }
+
+    //! Parses one matrix market coordinate line [p, eol) and pushes its entries, returns false for comments, blank or malformed lines
+    template <typename IT1, typename NT1>
+    static bool ProcessLine(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, const char * p, int symmetric, int type, bool onebased)
+    {
+        p = SkipBlanks(p);
+        if(*p == '%' || *p == '\n') return false;
+        int64_t ii, jj;
+        if((p = ScanInt(p, ii)) == NULL) return false;
+        if((p = ScanInt(p, jj)) == NULL) return false;
+        if(type == 0)
+        {
+            double vv;
+            if(ScanReal(p, vv) == NULL) return false;
+            SpHelper::push_to_vectors(rows, cols, vals, ii, jj, vv, symmetric, onebased);
+        }
+        else if(type == 1)
+        {
+            int64_t vv;
+            if(ScanInt(p, vv) == NULL) return false;
+            SpHelper::push_to_vectors(rows, cols, vals, ii, jj, vv, symmetric, onebased);
+        }
+        else
+        {
+            SpHelper::push_to_vectors(rows, cols, vals, ii, jj, 1, symmetric, onebased);
+        }
+        return true;
+    }
+
+    /**
+     * Cuts the whole lines in [lbeg, lend) into one chunk per thread at line breaks, chunk t is [chunkbeg[t], chunkbeg[t+1])
+     * With THREADED, nthreads is set to the number of OpenMP threads (or to 1 for small buffers where forking is not worth it)
+     */
+    static std::vector<const char *> SplitAtLineBreaks(const char * lbeg, const char * lend, int & nthreads)
+    {
+        nthreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+        {
+            nthreads = omp_get_num_threads();
+        }
+        if((lend - lbeg) < (1 << 16)) nthreads = 1;     // not worth forking for a few lines
+#endif
+        std::vector<const char *> chunkbeg(nthreads+1);
+        chunkbeg[0] = lbeg;
+        chunkbeg[nthreads] = lend;
+        for(int t=1; t<nthreads; ++t)
+        {
+            // first line start at or after the even split point; lend[-1] is a line break so memchr always succeeds
+            const char * guess = std::max(chunkbeg[t-1], lbeg + (lend - lbeg) / nthreads * t);
+            if(guess == lbeg) chunkbeg[t] = lbeg;
+            else chunkbeg[t] = static_cast<const char *>(memchr(guess-1, '\n', lend - guess + 1)) + 1;
+        }
+        return chunkbeg;
+    }
+
+    /**
+     * Runs parseline(rows, cols, vals, p) on every line p of [lbeg, lend), which must consist of whole lines (lend[-1] == '\n')
+     * With THREADED, each thread parses one chunk into its own vectors and the results are appended in file order
+     * @return number of lines for which parseline returned true
+     */
+    template <typename IT1, typename NT1, typename LINEPARSER>
+    static int64_t ParseLines(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, const char * lbeg, const char * lend, LINEPARSER parseline)
+    {
+        if(lbeg >= lend) return 0;
+        int nthreads;
+        std::vector<const char *> chunkbeg = SplitAtLineBreaks(lbeg, lend, nthreads);
+
+        std::vector< std::vector<IT1> > trows(nthreads);
+        std::vector< std::vector<IT1> > tcols(nthreads);
+        std::vector< std::vector<NT1> > tvals(nthreads);
+        std::vector<int64_t> tentries(nthreads, 0);
+#ifdef THREADED
+#pragma omp parallel for schedule(static, 1) num_threads(nthreads)
+#endif
+        for(int t=0; t<nthreads; ++t)
+        {
+            // with a single thread, append directly into the output vectors
+            std::vector<IT1> & myrows = (nthreads == 1) ? rows : trows[t];
+            std::vector<IT1> & mycols = (nthreads == 1) ? cols : tcols[t];
+            std::vector<NT1> & myvals = (nthreads == 1) ? vals : tvals[t];
+            const char * p = chunkbeg[t];
+            while(p < chunkbeg[t+1])
+            {
+                if(parseline(myrows, mycols, myvals, p))
+                    ++tentries[t];
+                p = static_cast<const char *>(memchr(p, '\n', chunkbeg[t+1] - p)) + 1;
+            }
+        }
+        if(nthreads == 1) return tentries[0];
+
+        std::vector<size_t> offsets(nthreads+1, rows.size());
+        for(int t=0; t<nthreads; ++t)
+            offsets[t+1] = offsets[t] + trows[t].size();
+        rows.resize(offsets[nthreads]);
+        cols.resize(offsets[nthreads]);
+        vals.resize(offsets[nthreads]);
+        int64_t entries = 0;
+#ifdef THREADED
+#pragma omp parallel for schedule(static, 1) num_threads(nthreads) reduction(+:entries)
+#endif
+        for(int t=0; t<nthreads; ++t)
+        {
+            std::copy(trows[t].begin(), trows[t].end(), rows.begin() + offsets[t]);
+            std::copy(tcols[t].begin(), tcols[t].end(), cols.begin() + offsets[t]);
+            std::copy(tvals[t].begin(), tvals[t].end(), vals.begin() + offsets[t]);
+            entries += tentries[t];
+            std::vector<IT1>().swap(trows[t]);
+            std::vector<IT1>().swap(tcols[t]);
+            std::vector<NT1>().swap(tvals[t]);
+        }
+        return entries;
+    }
+
+    /**
+     * Zero-copy version of ProcessLines that tokenizes the raw bytes [lbeg, lend) returned by SpParHelper::FetchBatch
+     * @return number of entries (lines with data) read
+     */
+    template <typename IT1, typename NT1>
+    static int64_t ProcessLines(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, const char * lbeg, const char * lend, int symmetric, int type, bool onebased = true)
+    {
+        if(type < 0 || type > 2)
+        {
+            std::cout << "COMBBLAS: Unrecognized matrix market scalar type" << std::endl;
+            return 0;
+        }
+        return ParseLines(rows, cols, vals, lbeg, lend, [symmetric, type, onebased](std::vector<IT1> & myrows, std::vector<IT1> & mycols, std::vector<NT1> & myvals, const char * p)
+        {
+            return ProcessLine(myrows, mycols, myvals, p, symmetric, type, onebased);
+        });
+    }
+
+    //! MurmurHash3 of a vertex name, which decides both its owner and its slot in a StringTable
+    static uint64_t HashName(const char * name, uint32_t len)
+    {
+        uint64_t hash;
+        MurmurHash3_x64_64(name, len, 0, &hash);
+        return hash;
+    }
+
+    //! Processor that numbers the vertex with the given name hash (hashes are spread uniformly over [0, nprocs))
+    static int HashOwner(uint64_t hash, int nprocs)
+    {
+        double range = static_cast<double>(hash) * static_cast<double>(nprocs);
+        size_t owner = range / static_cast<double>(std::numeric_limits<uint64_t>::max());
+        return std::min(static_cast<int>(owner), nprocs-1);     // hash == max would otherwise map to nprocs
+    }
+
+    //! Finds the whitespace delimited token starting at p (after blanks), returns the position after it or NULL at the end of the line
+    static const char * ScanToken(const char * p, const char * & tbeg)
+    {
+        p = SkipBlanks(p);
+        if(*p == '\n' || *p == '\0') return NULL;
+        tbeg = p;
+        while(*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && *p != '\0') ++p;
+        return p;
+    }
+
+    //! SplitMix64 finalizer, the stateless mixing function behind the counter based random numbers below
+    static uint64_t CounterMix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    //! The counter-th uniform number in (0,1) of the stream named by key; counter is advanced
+    static double CounterUniform(uint64_t key, uint64_t & counter)
+    {
+        uint64_t bits = CounterMix(key ^ CounterMix(counter++));
+        return (static_cast<double>(bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);	// 53 random bits, never 0 or 1
+    }
+
+    /**
+     * Binomial(n,p) sample drawn from the stream named by key. Small means are sampled exactly by inversion,
+     * large ones (n*min(p,1-p) >= 32) with the normal approximation, which is plenty for graph generation
+     */
+    static uint64_t CounterBinomial(uint64_t n, double p, uint64_t key, uint64_t & counter)
+    {
+        if(n == 0 || p <= 0.0) return 0;
+        if(p >= 1.0) return n;
+        if(p > 0.5) return n - CounterBinomial(n, 1.0-p, key, counter);
+        double q = 1.0 - p;
+        double mean = static_cast<double>(n) * p;
+        if(mean < 32.0)
+        {
+            double ratio = p / q;
+            double prob = std::pow(q, static_cast<double>(n));	// P(X=0)
+            double u = CounterUniform(key, counter);
+            uint64_t x = 0;
+            while(u > prob && x < n)
+            {
+                u -= prob;
+                ++x;
+                prob *= ratio * static_cast<double>(n-x+1) / static_cast<double>(x);
+            }
+            return x;
+        }
+        double u1 = CounterUniform(key, counter);
+        double u2 = CounterUniform(key, counter);
+        double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        double x = std::floor(mean + std::sqrt(mean * q) * z + 0.5);
+        if(x <= 0.0) return 0;
+        return (x >= static_cast<double>(n)) ? n : static_cast<uint64_t>(x);
+    }
+
+    /**
+     * Collects the distinct vertex names (first two tokens of each line) in [lbeg, lend) into keys, hashed with HashName
+     * With THREADED, every thread first deduplicates its own chunk into a private table, so only those distinct names are merged
+     * @return number of edges (lines with two names) read
+     */
+    static int64_t ProcessLinesWithStringKeys(StringTable & keys, const char * lbeg, const char * lend)
+    {
+        if(lbeg >= lend) return 0;
+        int nthreads;
+        std::vector<const char *> chunkbeg = SplitAtLineBreaks(lbeg, lend, nthreads);
+
+        std::vector<StringTable> tkeys(nthreads);
+        std::vector<int64_t> tedges(nthreads, 0);
+#ifdef THREADED
+#pragma omp parallel for schedule(static, 1) num_threads(nthreads)
+#endif
+        for(int t=0; t<nthreads; ++t)
+        {
+            StringTable & mykeys = (nthreads == 1) ? keys : tkeys[t];
+            const char * p = chunkbeg[t];
+            while(p < chunkbeg[t+1])
+            {
+                const char * fr, * to, * frend, * toend;
+                if((frend = ScanToken(p, fr)) != NULL && (toend = ScanToken(frend, to)) != NULL)
+                {
+                    mykeys.Insert(fr, frend-fr, HashName(fr, frend-fr), 0);
+                    mykeys.Insert(to, toend-to, HashName(to, toend-to), 0);
+                    ++tedges[t];
+                }
+                p = static_cast<const char *>(memchr(p, '\n', chunkbeg[t+1] - p)) + 1;
+            }
+        }
+        if(nthreads > 1)
+        {
+            for(int t=0; t<nthreads; ++t)
+            {
+                for(size_t id = 0; id < tkeys[t].size(); ++id)
+                    keys.Insert(tkeys[t].Name(id), tkeys[t].Length(id), tkeys[t].Hash(id), 0);
+                tkeys[t].Clear();
+            }
+        }
+        return std::accumulate(tedges.begin(), tedges.end(), static_cast<int64_t>(0));
+    }
+
+    /**
+     * Renames the labeled edges "from to [value]" in [lbeg, lend) to (ultperm[from], ultperm[to], value)
+     * A missing value defaults to 1; lines with less than two names or with names absent from ultperm are skipped
+     * @return number of edges read
+     */
+    template <typename IT1, typename NT1>
+    static int64_t ProcessStrLinesNPermute(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, const char * lbeg, const char * lend, const StringTable & ultperm)
+    {
+        return ParseLines(rows, cols, vals, lbeg, lend, [&ultperm](std::vector<IT1> & myrows, std::vector<IT1> & mycols, std::vector<NT1> & myvals, const char * p)
+        {
+            const char * fr, * to, * frend, * toend;
+            if((frend = ScanToken(p, fr)) == NULL || (toend = ScanToken(frend, to)) == NULL)
+                return false;
+            const uint64_t * frid = ultperm.Find(fr, frend-fr, HashName(fr, frend-fr));
+            const uint64_t * toid = ultperm.Find(to, toend-to, HashName(to, toend-to));
+            if(frid == NULL || toid == NULL) return false;
+            double vv;
+            if(ScanReal(toend, vv) == NULL) vv = 1;
+            myrows.emplace_back(static_cast<IT1>(*frid));
+            mycols.emplace_back(static_cast<IT1>(*toid));
+            myvals.emplace_back(static_cast<NT1>(vv));
+            return true;
+        });
+    }
+
 
 	template <typename T>
 	static const T * p2a (const std::vector<T> & v)   // pointer to array
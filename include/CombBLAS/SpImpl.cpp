@@ -291,6 +291,7 @@ template <typename SR, typename IT, typename IVT, typename OVT>
 void SpImpl<SR,IT,bool,IVT,OVT>::SpMXSpV_ForThreading(const Dcsc<IT,bool> & Adcsc, int32_t mA, const int32_t * indx, const IVT * numx, int32_t veclen, std::vector<int32_t> & indy, std::vector<OVT> & numy, int32_t offset, std::vector<OVT> & localy, BitMap & isthere, std::vector<uint32_t> & nzinds)
 {
 	// The following piece of code is not general, but it's more memory efficient than FillColInds
+	nzinds.clear();	// preallocated buffers (see PreAllocatedSPA) are only used for their capacity
 	int32_t k = 0; 	// index to indx vector
 	IT i = 0; 	// index to columns of matrix
 	while(i< Adcsc.nzc && k < veclen)
@@ -324,6 +325,7 @@ void SpImpl<SR,IT,bool,IVT,OVT>::SpMXSpV_ForThreading(const Dcsc<IT,bool> & Adcs
 	{
 		indy[i] = nzinds[i] + offset;	// return column-global index and let gespmv determine the receiver's local index
 		numy[i] = localy[nzinds[i]]; 	
+		isthere.reset_bit(nzinds[i]);	// leave the SPA clean for the next call
 	}
 }
 
@@ -0,0 +1,106 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef _SPMSPV_CONTEXT_H
+#define _SPMSPV_CONTEXT_H
+#include <vector>
+#include <algorithm>
+#include "PreAllocatedSPA.h"
+
+namespace combblas {
+
+/**
+  * Persistent workspace of the sparse matrix X sparse vector multiplication for a fixed matrix
+  * Owns the transposed and gathered input vector, the local output, the send/receive buffers,
+  * the per-split outputs of multithreaded matrices, and the SPA, so that an iterative algorithm
+  * calling SpMV(A, x, y, indexisvalue, context) thousands of times only pays for allocation
+  * (and first touch) when a buffer has to grow. Buffers grow geometrically and are never shrunk.
+  * IVT: input vector numerical type, OVT: output vector numerical type
+  */
+template <class IVT, class OVT>
+class SpMSpVContext
+{
+public:
+	SpMSpVContext(): growths(0) {};
+
+	/**
+	  * @param[in] withSPA {also preallocate the sparse accumulator used by multithreaded and CSC matrices}
+	  */
+	template <class PARMAT>
+	SpMSpVContext(const PARMAT & A, bool withSPA = true): growths(0)
+	{
+		if(withSPA)
+			SPA = PreAllocatedSPA<OVT>(A.seq());
+		int splits = A.seq().getnsplit();
+		splitinds.resize(splits);
+		splitnums.resize(splits);
+	}
+
+	//! Sets buf to n entries, reallocating geometrically if it does not fit in the current capacity
+	template <typename T>
+	void Grow(std::vector<T> & buf, size_t n)
+	{
+		if(buf.capacity() < n)
+		{
+			buf.reserve(std::max(n, 2*buf.capacity()));
+			++growths;
+		}
+		buf.resize(n);
+	}
+
+	std::vector<int32_t> xinds;		// local indices of x as 32-bit integers
+	std::vector<int32_t> trxinds;		// transposed x
+	std::vector<IVT> trxnums;
+	std::vector<int32_t> indacc;		// x gathered along the processor column
+	std::vector<IVT> numacc;
+	std::vector<int> colnz;
+	std::vector<int> coldpls;
+
+	std::vector<int32_t> indy;		// local y, row sorted, later packed by recipient
+	std::vector<OVT> numy;
+	std::vector< std::vector<int32_t> > splitinds;	// local y of each split of a multithreaded matrix
+	std::vector< std::vector<OVT> > splitnums;
+	std::vector<int> splitdispls;
+
+	std::vector<int> sendcnt;
+	std::vector<int> sdispls;
+	std::vector<int> recvcnt;
+	std::vector<int> rdispls;
+	std::vector<int32_t> recvindbuf;
+	std::vector<OVT> recvnumbuf;
+	std::vector<int32_t *> indsvec;
+	std::vector<OVT *> numsvec;
+
+	PreAllocatedSPA<OVT> SPA;
+	int64_t growths;		// number of times a buffer had to be reallocated
+};
+
+}
+
+#endif
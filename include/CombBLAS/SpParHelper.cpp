@@ -78,12 +78,12 @@ void SpParHelper::ReDistributeToVector(int* & map_scnt, std::vector< std::vector
    	MPI_Type_contiguous(sizeof(char[MAXVERTNAME]), MPI_CHAR, &MPI_STRING);
     	MPI_Type_commit(&MPI_STRING);
 
-    	MPI_Alltoallv(sendbuf, map_scnt, map_sdspl, MPI_STRING, recvbuf, map_rcnt, map_rdspl, MPI_STRING, comm);
+    	Alltoallv(sendbuf, map_scnt, map_sdspl, MPI_STRING, recvbuf, map_rcnt, map_rdspl, MPI_STRING, comm);
     	free(sendbuf);	// can't delete[] so use free
     	MPI_Type_free(&MPI_STRING);
 
     	IT * recvinds = new IT[totmaprecv];
-    	MPI_Alltoallv(sendinds, map_scnt, map_sdspl, MPIType<IT>(), recvinds, map_rcnt, map_rdspl, MPIType<IT>(), comm);
+    	Alltoallv(sendinds, map_scnt, map_sdspl, MPIType<IT>(), recvinds, map_rcnt, map_rdspl, MPIType<IT>(), comm);
     	DeleteAll(sendinds, map_scnt, map_sdspl, map_rcnt, map_rdspl);
 
     	if(!std::is_sorted(recvinds, recvinds+totmaprecv))
@@ -189,6 +189,167 @@ void SpParHelper::MemoryEfficientPSort(std::pair<KEY,VAL> * array, IT length, IT
 }
 
 
+/**
+ * Distributed radix (histogram) sort of integer keys, with a payload, kept as separate arrays (struct of arrays).
+ * The sort is stable: equal keys stay in their global input order (rank, then position), so a payload of global
+ * indices gives the same result as sorting (key, index) pairs. On return, every process has as many elements as it started with.
+ * 	1) a global histogram of the top bits of (key, global position) assigns buckets of consecutive keys to processes,
+ * 	   positions are included so that heavily repeated keys are still split evenly
+ * 	2) a single all-to-all sends every element to the owner of its bucket
+ * 	3) a local LSD radix sort (as in PBBS, but with 11-bit digits and skipping constant digits) orders the received elements
+ * 	4) a final shift moves the boundary elements so that the original local sizes are restored
+ */
+template<typename KEY, typename VAL>
+void SpParHelper::RadixPSort(std::vector<KEY> & keys, std::vector<VAL> & vals, const MPI_Comm & comm)
+{
+	static_assert(std::is_integral<KEY>::value && !std::is_same<KEY,bool>::value, "RadixPSort needs integer keys");
+	typedef typename std::make_unsigned<KEY>::type UKEY;
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+
+	int64_t length = keys.size();
+	std::vector<int64_t> dist(nprocs);	// local sizes, before and after
+	MPI_Allgather(&length, 1, MPIType<int64_t>(), dist.data(), 1, MPIType<int64_t>(), comm);
+	std::vector<int64_t> distprefix(nprocs+1, 0);
+	std::partial_sum(dist.begin(), dist.end(), distprefix.begin()+1);
+	int64_t total = distprefix[nprocs];
+	if(total == 0)	return;
+
+	// order preserving map to unsigned, relative to the global minimum
+	const UKEY flip = std::is_signed<KEY>::value ? (static_cast<UKEY>(1) << (8*sizeof(KEY)-1)) : 0;
+	uint64_t range[2] = {std::numeric_limits<uint64_t>::max(), 0};	// min, and max complemented so that a single MPI_MIN does both
+	for(int64_t i=0; i< length; ++i)
+	{
+		uint64_t u = static_cast<UKEY>(static_cast<UKEY>(keys[i]) ^ flip);
+		range[0] = std::min(range[0], u);
+		range[1] = std::min(range[1], ~u);
+	}
+	if(length == 0)	range[1] = std::numeric_limits<uint64_t>::max();
+	MPI_Allreduce(MPI_IN_PLACE, range, 2, MPIType<uint64_t>(), MPI_MIN, comm);
+	uint64_t minkey = range[0];
+	uint64_t keyspan = (~range[1]) - minkey;
+	auto bitsof = [](uint64_t x) { int b = 0; while(x > 0) { ++b; x >>= 1; } return b; };
+	int keybits = bitsof(keyspan);
+	auto relkey = [minkey, flip](KEY key) { return static_cast<uint64_t>(static_cast<UKEY>(static_cast<UKEY>(key) ^ flip)) - minkey; };
+
+	// 1) histogram of the top digit of (relkey, position)
+	int posbits = bitsof(static_cast<uint64_t>(total-1));
+	int digitbits = std::min(keybits + posbits, std::max(8, std::min(16, bitsof(static_cast<uint64_t>(nprocs)) + 6)));
+	auto topdigit = [keybits, posbits, digitbits](uint64_t rkey, uint64_t pos) -> uint64_t
+	{
+		if(keybits >= digitbits)	return rkey >> (keybits - digitbits);
+		int rest = digitbits - keybits;	// taken from the position
+		return (rkey << rest) | (pos >> (posbits - rest));
+	};
+	int64_t mystart = distprefix[myrank];
+	std::vector<uint32_t> digits(length);
+	std::vector<int64_t> hist(static_cast<size_t>(1) << digitbits, 0);
+	for(int64_t i=0; i< length; ++i)
+	{
+		digits[i] = static_cast<uint32_t>(topdigit(relkey(keys[i]), mystart + i));
+		++hist[digits[i]];
+	}
+	MPI_Allreduce(MPI_IN_PLACE, hist.data(), static_cast<int>(hist.size()), MPIType<int64_t>(), MPI_SUM, comm);
+
+	// a bucket goes to the process whose final range contains its first element
+	std::vector<int> bucketowner(hist.size());
+	int64_t bucketstart = 0;
+	for(size_t b=0; b< hist.size(); ++b)
+	{
+		bucketowner[b] = static_cast<int>(std::upper_bound(distprefix.begin(), distprefix.end(), bucketstart) - distprefix.begin()) - 1;
+		bucketowner[b] = std::min(bucketowner[b], nprocs-1);
+		bucketstart += hist[b];
+	}
+	std::vector<int64_t>().swap(hist);
+
+	// 2) one exchange, packed stably by destination
+	std::vector<int> sendcnt(nprocs, 0), recvcnt(nprocs), sdispls(nprocs+1, 0), rdispls(nprocs+1, 0);
+	for(int64_t i=0; i< length; ++i)
+		++sendcnt[bucketowner[digits[i]]];
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, comm);
+	std::partial_sum(sendcnt.begin(), sendcnt.end(), sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end(), rdispls.begin()+1);
+	std::vector<KEY> sendkeys(length);
+	std::vector<VAL> sendvals(length);
+	{
+		std::vector<int> fill(sdispls.begin(), sdispls.end()-1);
+		for(int64_t i=0; i< length; ++i)
+		{
+			int dest = bucketowner[digits[i]];
+			sendkeys[fill[dest]] = keys[i];
+			sendvals[fill[dest]++] = vals[i];
+		}
+	}
+	std::vector<uint32_t>().swap(digits);
+	std::vector<KEY>().swap(keys);
+	std::vector<VAL>().swap(vals);
+	int64_t recvtotal = rdispls[nprocs];
+	std::vector<KEY> recvkeys(recvtotal);
+	std::vector<VAL> recvvals(recvtotal);
+	Alltoallv(sendkeys.data(), sendcnt.data(), sdispls.data(), MPIType<KEY>(), recvkeys.data(), recvcnt.data(), rdispls.data(), MPIType<KEY>(), comm);
+	Alltoallv(sendvals.data(), sendcnt.data(), sdispls.data(), MPIType<VAL>(), recvvals.data(), recvcnt.data(), rdispls.data(), MPIType<VAL>(), comm);
+	// sources arrive in rank order and each of them in its local order, so the input is in global input order
+
+	// 3) local stable LSD radix sort of the relative keys (the send buffers are reused as the scratch space)
+	std::vector<uint64_t> rkeys(recvtotal), rscratch(recvtotal);
+	for(int64_t i=0; i< recvtotal; ++i)
+		rkeys[i] = relkey(recvkeys[i]);
+	std::vector<KEY>().swap(recvkeys);
+	std::vector<KEY>().swap(sendkeys);
+	sendvals.resize(recvtotal);
+	const int radixbits = 11;	// 2K counters stay in cache
+	const uint64_t mask = (static_cast<uint64_t>(1) << radixbits) - 1;
+	std::vector<int64_t> counts(static_cast<size_t>(1) << radixbits);
+	for(int offset = 0; offset < keybits; offset += radixbits)
+	{
+		std::fill(counts.begin(), counts.end(), 0);
+		for(int64_t i=0; i< recvtotal; ++i)
+			++counts[(rkeys[i] >> offset) & mask];
+		if(recvtotal == 0 || counts[(rkeys[0] >> offset) & mask] == recvtotal)	continue;	// the same digit everywhere
+		int64_t sum = 0;
+		for(size_t k=0; k< counts.size(); ++k)
+		{
+			int64_t c = counts[k];
+			counts[k] = sum;
+			sum += c;
+		}
+		for(int64_t i=0; i< recvtotal; ++i)
+		{
+			int64_t pos = counts[(rkeys[i] >> offset) & mask]++;
+			rscratch[pos] = rkeys[i];
+			sendvals[pos] = recvvals[i];
+		}
+		rkeys.swap(rscratch);
+		recvvals.swap(sendvals);
+	}
+	std::vector<uint64_t>().swap(rscratch);
+	std::vector<VAL>().swap(sendvals);
+	recvkeys.resize(recvtotal);
+	for(int64_t i=0; i< recvtotal; ++i)
+		recvkeys[i] = static_cast<KEY>(static_cast<UKEY>(static_cast<UKEY>(rkeys[i] + minkey) ^ flip));
+	std::vector<uint64_t>().swap(rkeys);
+
+	// 4) restore the original local sizes: the sorted sequence is now held in rank order with local sizes recvtotal
+	std::vector<int64_t> held(nprocs);
+	MPI_Allgather(&recvtotal, 1, MPIType<int64_t>(), held.data(), 1, MPIType<int64_t>(), comm);
+	std::vector<int64_t> heldprefix(nprocs+1, 0);
+	std::partial_sum(held.begin(), held.end(), heldprefix.begin()+1);
+	auto overlap = [](int64_t abeg, int64_t aend, int64_t bbeg, int64_t bend) { return std::max(static_cast<int64_t>(0), std::min(aend, bend) - std::max(abeg, bbeg)); };
+	for(int i=0; i< nprocs; ++i)
+	{
+		sendcnt[i] = static_cast<int>(overlap(heldprefix[myrank], heldprefix[myrank+1], distprefix[i], distprefix[i+1]));
+		recvcnt[i] = static_cast<int>(overlap(distprefix[myrank], distprefix[myrank+1], heldprefix[i], heldprefix[i+1]));
+	}
+	std::partial_sum(sendcnt.begin(), sendcnt.end(), sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end(), rdispls.begin()+1);
+	keys.resize(length);
+	vals.resize(length);
+	Alltoallv(recvkeys.data(), sendcnt.data(), sdispls.data(), MPIType<KEY>(), keys.data(), recvcnt.data(), rdispls.data(), MPIType<KEY>(), comm);
+	Alltoallv(recvvals.data(), sendcnt.data(), sdispls.data(), MPIType<VAL>(), vals.data(), recvcnt.data(), rdispls.data(), MPIType<VAL>(), comm);
+}
+
+
 /*
  TODO: This function is just a hack at this moment. 
  The payload (VAL) can only be integer at this moment.
@@ -480,7 +641,7 @@ void SpParHelper::BipartiteSwap(std::pair<KEY,VAL> * low, std::pair<KEY,VAL> * a
 	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdpls+1);
 	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdpls+1);
 
-	MPI_Alltoallv(bufbegin, sendcnt, sdpls, MPI_valueType, receives, recvcnt, rdpls, MPI_valueType, comm);  // sparse swap
+	Alltoallv(bufbegin, sendcnt, sdpls, MPI_valueType, receives, recvcnt, rdpls, MPI_valueType, comm);  // sparse swap
 	
 	DeleteAll(sendcnt, recvcnt, sdpls, rdpls);
   std::copy(receives, receives+totrecvcnt, bufbegin);
@@ -854,6 +1015,87 @@ inline void SpParHelper::Print(const std::string & s, MPI_Comm & world)
 }
 
 
+/**
+ * Reads a single integer (or "max", meaning no limit) from a cgroup/proc file
+ * @return {-1 if the file does not exist or does not contain a limit}
+ **/
+inline int64_t ReadMemoryValue(const std::string & filename)
+{
+	std::ifstream in(filename.c_str());
+	std::string token;
+	if(!(in >> token) || token == "max")
+		return -1;
+	return static_cast<int64_t>(strtoll(token.c_str(), NULL, 10));
+}
+
+/**
+ * Memory (in bytes) that the calling process can still allocate, without being OOM killed
+ * The node-level figure is the minimum of MemAvailable in /proc/meminfo and the headroom
+ * of the memory cgroup (v2 or v1) the process runs in, which is divided evenly among the
+ * processes of comm that share the node. The result is reduced to its minimum over comm.
+ **/
+inline int64_t SpParHelper::AvailableMemory(MPI_Comm & comm)
+{
+	int64_t nodeavail = std::numeric_limits<int64_t>::max();
+	std::ifstream meminfo("/proc/meminfo");
+	std::string key, unit;
+	int64_t value;
+	while(meminfo >> key >> value >> unit)
+	{
+		if(key == "MemAvailable:")
+		{
+			nodeavail = value * 1024;	// reported in kB
+			break;
+		}
+	}
+
+	// cgroup paths relative to the mount points, from lines like "0::/path" (v2) or "4:memory:/path" (v1)
+	std::string v2path, v1path;
+	std::ifstream cgroups("/proc/self/cgroup");
+	std::string line;
+	while(std::getline(cgroups, line))
+	{
+		size_t first = line.find(':');
+		size_t second = line.find(':', first+1);
+		if(first == std::string::npos || second == std::string::npos) continue;
+		std::string controllers = line.substr(first+1, second-first-1);
+		if(controllers.empty())	v2path = line.substr(second+1);
+		else if(controllers.find("memory") != std::string::npos) v1path = line.substr(second+1);
+	}
+	// nested cgroups can be limited by any ancestor, hence walk up to the mount point
+	std::vector< std::pair<std::string, std::string> > candidates;	// (limit file, usage file)
+	for(std::string path = v2path; ; path = path.substr(0, path.find_last_of('/')))
+	{
+		std::string dir = "/sys/fs/cgroup" + path;
+		candidates.push_back(std::make_pair(dir + "/memory.max", dir + "/memory.current"));
+		if(path.empty() || path == "/") break;
+	}
+	for(std::string path = v1path; ; path = path.substr(0, path.find_last_of('/')))
+	{
+		std::string dir = "/sys/fs/cgroup/memory" + path;
+		candidates.push_back(std::make_pair(dir + "/memory.limit_in_bytes", dir + "/memory.usage_in_bytes"));
+		if(path.empty() || path == "/") break;
+	}
+	for(size_t i=0; i< candidates.size(); ++i)
+	{
+		int64_t limit = ReadMemoryValue(candidates[i].first);
+		int64_t usage = ReadMemoryValue(candidates[i].second);
+		if(limit > 0 && usage >= 0 && limit < (int64_t) 1 << 60)	// v1 reports "unlimited" as a huge number
+			nodeavail = std::min(nodeavail, std::max(limit - usage, static_cast<int64_t>(0)));
+	}
+
+	MPI_Comm nodecomm;
+	int nodeprocs;
+	MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodecomm);
+	MPI_Comm_size(nodecomm, &nodeprocs);
+	MPI_Comm_free(&nodecomm);
+
+	int64_t myavail = nodeavail / nodeprocs;
+	int64_t minavail;
+	MPI_Allreduce(&myavail, &minavail, 1, MPIType<int64_t>(), MPI_MIN, comm);
+	return minavail;
+}
+
 inline void SpParHelper::check_newline(int *bytes_read, int bytes_requested, char *buf)
 {
     if ((*bytes_read) < bytes_requested) {
@@ -929,6 +1171,444 @@ inline bool SpParHelper::FetchBatch(MPI_File & infile, MPI_Offset & curpos, MPI_
     else    return false;
 }
 
+/**
+ * Zero-copy version of FetchBatch: reads the next chunk of [curpos, end_fpos) into buf, which is reused across calls,
+ * and sets [lbeg, lend) to the whole lines in it that start before end_fpos (lend[-1] is always a line break)
+ * The lines are meant to be tokenized in place by SpHelper::ProcessLines; no per-line string is ever created
+ * Same partitioning rules as the string version: a line belongs to the rank whose byte range contains its first byte
+ * @return true if there is nothing left to read after this batch
+ */
+inline bool SpParHelper::FetchBatch(MPI_File & infile, MPI_Offset & curpos, MPI_Offset end_fpos, bool firstcall, std::vector<char> & buf, const char * & lbeg, const char * & lend, int myrank, size_t bytes2fetch)
+{
+    lbeg = lend = NULL;
+    bool skipfirst = (firstcall && myrank != 0);
+    if(skipfirst)
+        curpos -= 1;    // first byte is to check whether we started at the beginning of a line
+    else if(curpos >= end_fpos)
+        return true;
+
+    while(true)
+    {
+        size_t request = bytes2fetch + (skipfirst ? 1 : 0);
+        if(buf.size() < request + 1) buf.resize(request + 1);   // one spare byte for a missing newline at the end of file
+        MPI_Status status;
+        int bytes_read;
+        MPI_File_read_at(infile, curpos, buf.data(), request, MPI_CHAR, &status);
+        MPI_Get_count(&status, MPI_CHAR, &bytes_read);
+        if(bytes_read <= 0) return true;
+        if(static_cast<size_t>(bytes_read) < request && buf[bytes_read-1] != '\n')
+        {
+            buf[bytes_read++] = '\n';
+            std::cout << "Error in Matrix Market format, appending missing newline at end of file" << std::endl;
+        }
+        const char * begin = buf.data();
+        const char * end = begin + bytes_read;
+        if(skipfirst)   // skip to the next line and let the preceeding processor take care of this partial line
+        {
+            const char * c = static_cast<const char *>(memchr(begin, '\n', end - begin));
+            if(c == NULL)   // the partial line is longer than the chunk
+            {
+                bytes2fetch *= 2;
+                continue;
+            }
+            curpos += (c - begin + 1);
+            begin = c + 1;
+            skipfirst = false;
+        }
+        MPI_Offset limit = end_fpos - curpos;   // lines that start before begin + limit are ours
+        if(limit <= 0) return true;
+        if(limit <= end - begin)
+        {
+            const char * c = static_cast<const char *>(memchr(begin + limit - 1, '\n', end - (begin + limit - 1)));
+            if(c != NULL)   // our last line ends within this chunk
+            {
+                lbeg = begin;
+                lend = c + 1;
+                curpos += (lend - lbeg);
+                return true;
+            }
+        }
+        const char * c = end;   // otherwise hand out all whole lines, the trailing partial one is re-read next time
+        while(c > begin && c[-1] != '\n') --c;
+        if(c == begin)  // not a single whole line in the chunk, re-read from curpos (now line aligned) with a larger chunk
+        {
+            bytes2fetch *= 2;
+            continue;
+        }
+        lbeg = begin;
+        lend = c;
+        curpos += (lend - lbeg);
+        return (curpos >= end_fpos);
+    }
+}
+
+
+/**
+ * Creates (and commits) a datatype that describes the memory regions [addrs[i], addrs[i]+bytes[i]) by absolute address,
+ * to be used with MPI_BOTTOM. Lets a single (collective) MPI call move several separately allocated arrays without
+ * packing them first. Each region is described in 1GB pieces, so region sizes are not limited to INT_MAX bytes
+ */
+inline void SpParHelper::MemoryRegionsType(const std::vector<const void *> & addrs, const std::vector<int64_t> & bytes, MPI_Datatype & newtype)
+{
+	const int64_t piece = (1 << 30);
+	MPI_Datatype piecetype;
+	MPI_Type_contiguous(static_cast<int>(piece), MPI_BYTE, &piecetype);
+
+	std::vector<int> blocklens;
+	std::vector<MPI_Aint> displs;
+	std::vector<MPI_Datatype> types;
+	for(size_t i=0; i< addrs.size(); ++i)
+	{
+		if(bytes[i] == 0) continue;
+		MPI_Aint address;
+		MPI_Get_address(addrs[i], &address);
+		int64_t npieces = bytes[i] / piece;
+		int remainder = static_cast<int>(bytes[i] % piece);
+		if(npieces > 0)
+		{
+			blocklens.push_back(static_cast<int>(npieces));
+			displs.push_back(address);
+			types.push_back(piecetype);
+		}
+		if(remainder > 0)
+		{
+			blocklens.push_back(remainder);
+			displs.push_back(address + npieces * piece);
+			types.push_back(MPI_BYTE);
+		}
+	}
+	MPI_Type_create_struct(static_cast<int>(blocklens.size()), blocklens.data(), displs.data(), types.data(), &newtype);
+	MPI_Type_commit(&newtype);
+	MPI_Type_free(&piecetype);
+}
+
+
+/**
+ * Node level view of a communicator, used by the node aware Alltoallv. Built on first use and cached on the communicator as an attribute.
+ * Ranks that share memory form a node (COMBBLAS_A2A_NODESIZE=k splits them further into groups of k ranks), the lowest rank of a node leads it
+ */
+struct A2ANodeTopology
+{
+	MPI_Comm nodecomm;
+	MPI_Comm leadercomm;	// MPI_COMM_NULL on non-leaders
+	int noderank, nodesize, maxnodesize, nodeid, nnodes;
+	std::vector<int> noderanks;	// ranks of the communicator grouped by node, ascending within each node
+	std::vector<int> nodedspl;	// node i owns noderanks[nodedspl[i]], ..., noderanks[nodedspl[i+1]-1]
+
+	A2ANodeTopology(MPI_Comm comm)
+	{
+		int myrank, nprocs;
+		MPI_Comm_rank(comm, &myrank);
+		MPI_Comm_size(comm, &nprocs);
+		MPI_Comm shared;
+		MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &shared);
+		const char * groupenv = getenv("COMBBLAS_A2A_NODESIZE");
+		int groupsize = groupenv ? atoi(groupenv) : 0;
+		if(groupsize > 0)
+		{
+			int sharedrank;
+			MPI_Comm_rank(shared, &sharedrank);
+			MPI_Comm_split(shared, sharedrank / groupsize, sharedrank, &nodecomm);
+			MPI_Comm_free(&shared);
+		}
+		else
+		{
+			nodecomm = shared;
+		}
+		MPI_Comm_rank(nodecomm, &noderank);
+		MPI_Comm_size(nodecomm, &nodesize);
+		MPI_Allreduce(&nodesize, &maxnodesize, 1, MPI_INT, MPI_MAX, comm);
+
+		MPI_Comm_split(comm, (noderank == 0) ? 0 : MPI_UNDEFINED, myrank, &leadercomm);
+		int ids[2];
+		if(noderank == 0)
+		{
+			MPI_Comm_rank(leadercomm, &ids[0]);
+			MPI_Comm_size(leadercomm, &ids[1]);
+		}
+		MPI_Bcast(ids, 2, MPI_INT, 0, nodecomm);
+		nodeid = ids[0];
+		nnodes = ids[1];
+
+		std::vector<int> nodeof(nprocs);
+		MPI_Allgather(&nodeid, 1, MPI_INT, nodeof.data(), 1, MPI_INT, comm);
+		nodedspl.assign(nnodes+1, 0);
+		for(int i=0; i< nprocs; ++i)
+			++nodedspl[nodeof[i]+1];
+		std::partial_sum(nodedspl.begin(), nodedspl.end(), nodedspl.begin());
+		std::vector<int> fill(nodedspl.begin(), nodedspl.end()-1);
+		noderanks.resize(nprocs);
+		for(int i=0; i< nprocs; ++i)
+			noderanks[fill[nodeof[i]]++] = i;
+	}
+
+	static int Delete(MPI_Comm, int, void * attr, void *)
+	{
+		A2ANodeTopology * topo = static_cast<A2ANodeTopology *>(attr);
+		MPI_Comm_free(&(topo->nodecomm));
+		if(topo->leadercomm != MPI_COMM_NULL)
+			MPI_Comm_free(&(topo->leadercomm));
+		delete topo;
+		return MPI_SUCCESS;
+	}
+
+	static A2ANodeTopology * Get(MPI_Comm comm)	// collective over comm when it builds the topology
+	{
+		static int keyval = MPI_KEYVAL_INVALID;
+		if(keyval == MPI_KEYVAL_INVALID)
+			MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, Delete, &keyval, NULL);
+		A2ANodeTopology * topo;
+		int found;
+		MPI_Comm_get_attr(comm, keyval, &topo, &found);
+		if(!found)
+		{
+			topo = new A2ANodeTopology(comm);
+			MPI_Comm_set_attr(comm, keyval, topo);
+		}
+		return topo;
+	}
+};
+
+
+inline AlltoallvMode & SpParHelper::AlltoallvSetting()
+{
+	static AlltoallvMode mode = []()
+	{
+		const char * env = getenv("COMBBLAS_ALLTOALLV");
+		std::string name = env ? env : "auto";
+		if(name == "direct")	return A2A_DIRECT;
+		if(name == "sparse")	return A2A_SPARSE;
+		if(name == "node")	return A2A_NODE;
+		return A2A_AUTO;
+	}();
+	return mode;
+}
+
+
+/**
+ * Drop-in replacement for MPI_Alltoallv, the single entry point for the irregular exchanges of the library. Depending on
+ * SpParHelper::AlltoallvSetting(), the exchange is
+ * 	- A2A_DIRECT: MPI_Alltoallv
+ * 	- A2A_SPARSE: nonblocking point-to-point messages for the nonzero counts only (both sides know them, so no extra round is needed)
+ * 	- A2A_NODE: node aware, messages are gathered on the node leaders, exchanged among leaders with one message per node pair, and scattered
+ * 	- A2A_AUTO: one of the above, chosen with a single allreduce of (peers, bytes); communicators smaller than A2A_MINRANKS use MPI_Alltoallv
+ * The node aware version needs contiguous datatypes (extent == size) and falls back to MPI_Alltoallv otherwise, or if a node's volume exceeds INT_MAX
+ */
+inline void SpParHelper::Alltoallv(const void * sendbuf, const int * sendcnt, const int * sdispls, MPI_Datatype sendtype,
+			void * recvbuf, const int * recvcnt, const int * rdispls, MPI_Datatype recvtype, MPI_Comm comm)
+{
+	int nprocs;
+	MPI_Comm_size(comm, &nprocs);
+	AlltoallvMode mode = AlltoallvSetting();
+	if(mode == A2A_DIRECT || (mode == A2A_AUTO && nprocs < A2A_MINRANKS))
+	{
+		MPI_Alltoallv(sendbuf, sendcnt, sdispls, sendtype, recvbuf, recvcnt, rdispls, recvtype, comm);
+		return;
+	}
+
+	MPI_Aint lb, sextent, rextent, truelb, trueextent;
+	int ssize, rsize;
+	MPI_Type_size(sendtype, &ssize);
+	MPI_Type_size(recvtype, &rsize);
+	MPI_Type_get_extent(sendtype, &lb, &sextent);
+	MPI_Type_get_true_extent(sendtype, &truelb, &trueextent);
+	bool contiguous = (lb == 0 && truelb == 0 && sextent == ssize && trueextent == ssize);
+	MPI_Type_get_extent(recvtype, &lb, &rextent);
+	MPI_Type_get_true_extent(recvtype, &truelb, &trueextent);
+	contiguous = contiguous && (lb == 0 && truelb == 0 && rextent == rsize && trueextent == rsize);
+
+	if(mode != A2A_SPARSE)	// every rank has to take the same path
+	{
+		int64_t stats[3] = {0, 0, contiguous ? 0 : 1};	// peers, bytes, noncontiguous
+		int64_t sentbytes = 0, recvbytes = 0, sendpeers = 0, recvpeers = 0;
+		for(int i=0; i< nprocs; ++i)
+		{
+			if(sendcnt[i] > 0)	{ ++sendpeers; sentbytes += static_cast<int64_t>(sendcnt[i]) * ssize; }
+			if(recvcnt[i] > 0)	{ ++recvpeers; recvbytes += static_cast<int64_t>(recvcnt[i]) * rsize; }
+		}
+		stats[0] = std::max(sendpeers, recvpeers);
+		stats[1] = std::max(sentbytes, recvbytes);
+		MPI_Allreduce(MPI_IN_PLACE, stats, 3, MPIType<int64_t>(), MPI_MAX, comm);
+
+		if(mode == A2A_AUTO && stats[0] * A2A_SPARSEFRACTION <= nprocs)
+		{
+			mode = A2A_SPARSE;
+		}
+		else if(stats[2] == 0 && (mode == A2A_NODE || stats[1] <= static_cast<int64_t>(A2A_SMALLMSG) * nprocs))
+		{
+			A2ANodeTopology * topo = A2ANodeTopology::Get(comm);
+			bool fits = (stats[1] * topo->maxnodesize <= static_cast<int64_t>(std::numeric_limits<int>::max()));
+			bool worthit = (topo->nnodes > 1 && topo->nnodes < nprocs);
+			mode = (fits && (mode == A2A_NODE || worthit)) ? A2A_NODE : A2A_DIRECT;
+		}
+		else
+		{
+			mode = A2A_DIRECT;
+		}
+	}
+
+	if(mode == A2A_SPARSE)
+	{
+		int myrank;
+		MPI_Comm_rank(comm, &myrank);
+		std::vector<MPI_Request> requests;
+		requests.reserve(2*nprocs);
+		for(int i=0; i< nprocs; ++i)
+		{
+			if(recvcnt[i] == 0)	continue;
+			requests.push_back(MPI_REQUEST_NULL);
+			MPI_Irecv(static_cast<char *>(recvbuf) + rdispls[i] * rextent, recvcnt[i], recvtype, i, A2ATAG, comm, &requests.back());
+		}
+		for(int k=1; k<= nprocs; ++k)	// start with the right neighbor so that the sends are spread out
+		{
+			int i = (myrank + k) % nprocs;
+			if(sendcnt[i] == 0)	continue;
+			requests.push_back(MPI_REQUEST_NULL);
+			MPI_Isend(static_cast<const char *>(sendbuf) + sdispls[i] * sextent, sendcnt[i], sendtype, i, A2ATAG, comm, &requests.back());
+		}
+		MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+	}
+	else if(mode == A2A_NODE)
+	{
+		A2ANodeTopology * topo = A2ANodeTopology::Get(comm);
+		const std::vector<int> & noderanks = topo->noderanks;
+		const std::vector<int> & nd = topo->nodedspl;
+		int nodesize = topo->nodesize;
+		int nnodes = topo->nnodes;
+
+		// pack the outgoing messages in node order, and gather them (with their sizes) on the leader
+		std::vector<int> mybytes(nprocs);
+		for(int i=0; i< nprocs; ++i)
+			mybytes[i] = sendcnt[noderanks[i]] * ssize;
+		std::vector<int> mydspl(nprocs+1, 0);
+		std::partial_sum(mybytes.begin(), mybytes.end(), mydspl.begin()+1);
+		std::vector<char> packed(mydspl[nprocs]);
+		for(int i=0; i< nprocs; ++i)
+			std::memcpy(packed.data() + mydspl[i], static_cast<const char *>(sendbuf) + static_cast<int64_t>(sdispls[noderanks[i]]) * ssize, mybytes[i]);
+
+		bool leader = (topo->noderank == 0);
+		std::vector<int> bytes;		// bytes[s*nprocs + i]: from local rank s to noderanks[i]
+		std::vector<int> gathercnt(nodesize), gatherdspl(nodesize+1, 0);
+		std::vector<char> gathered;
+		if(leader)	bytes.resize(static_cast<size_t>(nodesize) * nprocs);
+		MPI_Gather(mybytes.data(), nprocs, MPI_INT, bytes.data(), nprocs, MPI_INT, 0, topo->nodecomm);
+		if(leader)
+		{
+			for(int s=0; s< nodesize; ++s)
+				gathercnt[s] = std::accumulate(bytes.begin() + static_cast<size_t>(s)*nprocs, bytes.begin() + static_cast<size_t>(s+1)*nprocs, 0);
+			std::partial_sum(gathercnt.begin(), gathercnt.end(), gatherdspl.begin()+1);
+			gathered.resize(gatherdspl[nodesize]);
+		}
+		MPI_Gatherv(packed.data(), mydspl[nprocs], MPI_BYTE, gathered.data(), gathercnt.data(), gatherdspl.data(), MPI_BYTE, 0, topo->nodecomm);
+		std::vector<char>().swap(packed);
+
+		std::vector<int> scattercnt(nodesize, 0), scatterdspl(nodesize+1, 0);
+		std::vector<char> scattered;
+		if(leader)
+		{
+			// sizes first: node n gets bytes[s][d] for all local s and all d on n, in (s,d) order
+			std::vector<int> cntsend(nnodes), cntrecv(nnodes), cntsdspl(nnodes+1, 0), cntrdspl(nnodes+1, 0);
+			for(int n=0; n< nnodes; ++n)
+			{
+				cntsend[n] = nodesize * (nd[n+1] - nd[n]);
+				cntrecv[n] = (nd[n+1] - nd[n]) * nodesize;
+			}
+			std::partial_sum(cntsend.begin(), cntsend.end(), cntsdspl.begin()+1);
+			std::partial_sum(cntrecv.begin(), cntrecv.end(), cntrdspl.begin()+1);
+			std::vector<int> sizesend(cntsdspl[nnodes]), sizerecv(cntrdspl[nnodes]);
+			std::vector<int> datasend(nnodes, 0), datarecv(nnodes, 0), datasdspl(nnodes+1, 0), datardspl(nnodes+1, 0);
+			for(int n=0; n< nnodes; ++n)
+			{
+				int k = cntsdspl[n];
+				for(int s=0; s< nodesize; ++s)
+				{
+					for(int i=nd[n]; i< nd[n+1]; ++i)
+					{
+						sizesend[k++] = bytes[static_cast<size_t>(s)*nprocs + i];
+						datasend[n] += bytes[static_cast<size_t>(s)*nprocs + i];
+					}
+				}
+			}
+			MPI_Alltoallv(sizesend.data(), cntsend.data(), cntsdspl.data(), MPI_INT, sizerecv.data(), cntrecv.data(), cntrdspl.data(), MPI_INT, topo->leadercomm);
+
+			// then the data, one message per node pair
+			std::partial_sum(datasend.begin(), datasend.end(), datasdspl.begin()+1);
+			std::vector<char> nodesend(datasdspl[nnodes]);
+			for(int n=0; n< nnodes; ++n)
+			{
+				int64_t offset = datasdspl[n];
+				for(int s=0; s< nodesize; ++s)	// messages of s to node n are contiguous in its packed buffer
+				{
+					int begin = std::accumulate(bytes.begin() + static_cast<size_t>(s)*nprocs, bytes.begin() + static_cast<size_t>(s)*nprocs + nd[n], 0);
+					int length = std::accumulate(bytes.begin() + static_cast<size_t>(s)*nprocs + nd[n], bytes.begin() + static_cast<size_t>(s)*nprocs + nd[n+1], 0);
+					std::memcpy(nodesend.data() + offset, gathered.data() + gatherdspl[s] + begin, length);
+					offset += length;
+				}
+			}
+			std::vector<char>().swap(gathered);
+			for(int m=0; m< nnodes; ++m)
+				datarecv[m] = std::accumulate(sizerecv.begin() + cntrdspl[m], sizerecv.begin() + cntrdspl[m+1], 0);
+			std::partial_sum(datarecv.begin(), datarecv.end(), datardspl.begin()+1);
+			std::vector<char> noderecv(datardspl[nnodes]);
+			MPI_Alltoallv(nodesend.data(), datasend.data(), datasdspl.data(), MPI_BYTE, noderecv.data(), datarecv.data(), datardspl.data(), MPI_BYTE, topo->leadercomm);
+			std::vector<char>().swap(nodesend);
+
+			// regroup by local destination, with the sources in node order
+			std::vector<int> msgdspl(sizerecv.size()+1, 0);	// offset of each (source, destination) message in noderecv
+			std::partial_sum(sizerecv.begin(), sizerecv.end(), msgdspl.begin()+1);
+			for(size_t k=0; k< sizerecv.size(); ++k)
+				scattercnt[k % nodesize] += sizerecv[k];
+			std::partial_sum(scattercnt.begin(), scattercnt.end(), scatterdspl.begin()+1);
+			scattered.resize(scatterdspl[nodesize]);
+			std::vector<int> fill(scatterdspl.begin(), scatterdspl.end()-1);
+			for(size_t k=0; k< sizerecv.size(); ++k)	// (m, s, d) order
+			{
+				int d = k % nodesize;
+				std::memcpy(scattered.data() + fill[d], noderecv.data() + msgdspl[k], sizerecv[k]);
+				fill[d] += sizerecv[k];
+			}
+		}
+		int myrecvbytes = 0;
+		for(int i=0; i< nprocs; ++i)
+			myrecvbytes += recvcnt[i] * rsize;
+		std::vector<char> incoming(myrecvbytes);
+		MPI_Scatterv(scattered.data(), scattercnt.data(), scatterdspl.data(), MPI_BYTE, incoming.data(), myrecvbytes, MPI_BYTE, 0, topo->nodecomm);
+		int64_t offset = 0;
+		for(int i=0; i< nprocs; ++i)
+		{
+			int source = noderanks[i];
+			std::memcpy(static_cast<char *>(recvbuf) + static_cast<int64_t>(rdispls[source]) * rsize, incoming.data() + offset, recvcnt[source] * rsize);
+			offset += recvcnt[source] * rsize;
+		}
+	}
+	else
+	{
+		MPI_Alltoallv(sendbuf, sendcnt, sdispls, sendtype, recvbuf, recvcnt, rdispls, recvtype, comm);
+	}
+}
+
+
+/**
+ * Point-to-point exchange of byte buffers whose sizes may exceed INT_MAX.
+ * Both sides must pass matching sizes (my sendbytes is the partner's recvbytes and vice versa), so that
+ * they agree on the number of rounds. Each round moves at most 1GB in each direction
+ */
+inline void SpParHelper::SendrecvBytes(const void * sendbuf, int64_t sendbytes, int dest, void * recvbuf, int64_t recvbytes, int source, int tag, MPI_Comm comm)
+{
+	const int64_t piece = (1 << 30);
+	int64_t rounds = std::max((sendbytes + piece - 1) / piece, (recvbytes + piece - 1) / piece);
+	const char * sendptr = static_cast<const char *>(sendbuf);
+	char * recvptr = static_cast<char *>(recvbuf);
+	for(int64_t i=0; i< std::max(rounds, static_cast<int64_t>(1)); ++i)	// always one round, even if both are empty
+	{
+		int64_t sendoffset = std::min(i * piece, sendbytes);
+		int64_t recvoffset = std::min(i * piece, recvbytes);
+		int sendcount = static_cast<int>(std::min(piece, sendbytes - sendoffset));
+		int recvcount = static_cast<int>(std::min(piece, recvbytes - recvoffset));
+		MPI_Sendrecv(sendptr + sendoffset, sendcount, MPI_BYTE, dest, tag, recvptr + recvoffset, recvcount, MPI_BYTE, source, tag, comm, MPI_STATUS_IGNORE);
+	}
+}
+
 
 inline void SpParHelper::WaitNFree(std::vector<MPI_Win> & arrwin)
 {
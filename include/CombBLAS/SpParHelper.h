@@ -36,6 +36,11 @@
 
 #include <vector>
 #include <array>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
 #include <mpi.h>
 #include "LocArr.h"
 #include "CommGrid.h"
@@ -70,6 +75,9 @@ public:
 
     	template<typename KEY, typename VAL, typename IT>
     	static std::vector<std::pair<KEY,VAL>> KeyValuePSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm);
+
+	template<typename KEY, typename VAL>
+	static void RadixPSort(std::vector<KEY> & keys, std::vector<VAL> & vals, const MPI_Comm & comm);
 	
 	template<typename KEY, typename VAL, typename IT>
 	static void DebugPrintKeys(std::pair<KEY,VAL> * array, IT length, IT * dist, MPI_Comm & World);
@@ -109,6 +117,16 @@ public:
     	static void PrintFile(const std::string & s, const std::string & filename, MPI_Comm & world);
     	static void check_newline(int *bytes_read, int bytes_requested, char *buf);
    	static bool FetchBatch(MPI_File & infile, MPI_Offset & curpos, MPI_Offset end_fpos, bool firstcall, std::vector<std::string> & lines, int myrank);
+   	static bool FetchBatch(MPI_File & infile, MPI_Offset & curpos, MPI_Offset end_fpos, bool firstcall, std::vector<char> & buf, const char * & lbeg, const char * & lend, int myrank, size_t bytes2fetch = 16*ONEMILLION);
+    
+	static void MemoryRegionsType(const std::vector<const void *> & addrs, const std::vector<int64_t> & bytes, MPI_Datatype & newtype);
+	static void Alltoallv(const void * sendbuf, const int * sendcnt, const int * sdispls, MPI_Datatype sendtype,
+			void * recvbuf, const int * recvcnt, const int * rdispls, MPI_Datatype recvtype, MPI_Comm comm);
+	static void SetAlltoallvMode(AlltoallvMode mode) { AlltoallvSetting() = mode; }
+	static AlltoallvMode & AlltoallvSetting();
+	static void SendrecvBytes(const void * sendbuf, int64_t sendbytes, int dest, void * recvbuf, int64_t recvbytes, int source, int tag, MPI_Comm comm);
+    
+	static int64_t AvailableMemory(MPI_Comm & comm);
     
 	static void WaitNFree(std::vector<MPI_Win> & arrwin);
 	static void FreeWindows(std::vector<MPI_Win> & arrwin);
@@ -37,6 +37,9 @@ extern "C" {
 }
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <mpi.h>
 #include <fstream>
@@ -115,8 +118,50 @@ SpParMat< IT,NT,DER >::~SpParMat ()
 template <class IT, class NT, class DER>
 void SpParMat< IT,NT,DER >::FreeMemory ()
 {
+	ReleaseViews();
 	if(spSeq != NULL) delete spSeq;
 	spSeq = NULL;
+	mappedblock.reset();
+	++version;
+}
+
+/**
+ * The transpose of this matrix, computed on the first call and kept until the matrix changes (i.e. until its version
+ * moves on), so that algorithms that need both A and A' of an unchanged matrix pay for the exchange only once.
+ * Collective when the view has to be (re)built; the reference is invalidated by the next change of this matrix
+ */
+template <class IT, class NT, class DER>
+const SpParMat< IT,NT,DER > & SpParMat< IT,NT,DER >::TransposeView() const
+{
+	if(!transposeview || transposeversion != version)
+	{
+		transposeview.reset();	// free the stale view before making the new one
+		transposeview = std::make_shared< SpParMat< IT,NT,DER > >(*this);
+		transposeview->Transpose();
+		transposeversion = version;
+	}
+	return *transposeview;
+}
+
+//! Local (no communication) CSR view of the local block, cached like TransposeView
+template <class IT, class NT, class DER>
+const DER & SpParMat< IT,NT,DER >::LocalRowView() const
+{
+	if(!rowview || rowversion != version)
+	{
+		rowview.reset();
+		rowview = std::make_shared<DER>(*spSeq);
+		rowview->Transpose();
+		rowversion = version;
+	}
+	return *rowview;
+}
+
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ReleaseViews() const
+{
+	transposeview.reset();
+	rowview.reset();
 }
 
 
@@ -514,7 +559,7 @@ bool SpParMat<IT,NT,DER>::Kselect2(FullyDistVec<GIT,VT> & rvec, IT k_limit) cons
             std::vector< std::pair<IT,NT> >().swap(tmppair[i]);	// clear memory
         }
         std::vector< std::pair<IT,NT> > recvpair(totrecv);
-        MPI_Alltoallv(sendpair, sendcnt, sdispls, MPI_pair, recvpair.data(), recvcnt, rdispls, MPI_pair, commGrid->GetWorld());
+        SpParHelper::Alltoallv(sendpair, sendcnt, sdispls, MPI_pair, recvpair.data(), recvcnt, rdispls, MPI_pair, commGrid->GetWorld());
         delete [] sendpair;
 
         IT updated = 0;
@@ -684,6 +729,7 @@ void SpParMat< IT,NT,DER >::ParallelBinaryWrite(std::string filename) const
 
     MPI_File thefile;
     MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile) ;
+    MPI_File_set_size(thefile, bytestotal);    // truncate any previous (larger) file
     MPI_File_set_view(thefile, bytesuntil, MPI_CHAR, MPI_CHAR, (char*)"native", MPI_INFO_NULL);
     
     int64_t batchSize = 256 * 1024 * 1024;   // 256 MB (per processor)
@@ -712,6 +758,769 @@ void SpParMat< IT,NT,DER >::ParallelBinaryWrite(std::string filename) const
        delete [] localdata;
 }
 
+/**
+ * Reads a binary (HKDT format 0) file written by ParallelBinaryWrite with the same IT and NT
+ * Every rank reads an equal share of the records with MPI-IO, in batches that are sent to their owners right away,
+ * unlike ReadDistribute where only the processor column heads touch the file
+ * @param[in] BinOp {combines the values of duplicate entries}
+ */
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat< IT,NT,DER >::ParallelBinaryRead(const std::string & filename, _BinaryOperation BinOp)
+{
+    typedef typename DER::LocalIT LIT;
+    static_assert(std::is_trivially_copyable<NT>::value, "binary files store numerical values as raw bytes");
+    int myrank = commGrid->GetRank();
+    int nprocs = commGrid->GetSize();
+    const int64_t headersize = 52;  // 4 characters + 6*8 integer space, as in ParallelBinaryWrite
+    const int64_t elementsize = 2*sizeof(IT)+sizeof(NT);
+
+    MPI_File thefile;
+    if(MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+    {
+        SpParHelper::Print("COMBBLAS: Input file doesn't exist\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, NOFILE);
+    }
+    char header[headersize];
+    uint64_t hdr[6];
+    MPI_Offset filesize;
+    MPI_File_get_size(thefile, &filesize);
+    MPI_File_read_at_all(thefile, 0, header, headersize, MPI_CHAR, MPI_STATUS_IGNORE);
+    std::memcpy(hdr, header+4, sizeof(hdr));
+    if(std::strncmp(header, "HKDT", 4) != 0 || hdr[2] != 0 || hdr[1] != sizeof(NT) || filesize != headersize + static_cast<int64_t>(hdr[5]) * elementsize)
+    {
+        SpParHelper::Print("COMBBLAS: " + filename + " is not a binary file of this matrix type\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, NOFILE);
+    }
+    IT total_m = hdr[3];
+    IT total_n = hdr[4];
+    int64_t total_nnz = hdr[5];
+
+    int64_t mybegin = total_nnz * myrank / nprocs;
+    int64_t myend = total_nnz * (myrank+1) / nprocs;
+    const int64_t batch = ONEMILLION;   // records per round
+    std::vector<char> buf;
+    std::vector<IT> rows, cols;     // global indices, converted to local ones when they are sent to their owners
+    std::vector<NT> vals;
+    std::vector< std::vector< std::tuple<LIT,LIT,NT> > > received;
+    int alldone = 0;
+    while(!alldone)
+    {
+        int64_t count = std::min(batch, myend - mybegin);
+        buf.resize(count * elementsize);
+        MPI_File_read_at(thefile, headersize + mybegin * elementsize, buf.data(), count * elementsize, MPI_CHAR, MPI_STATUS_IGNORE);
+        for(int64_t i=0; i< count; ++i)
+        {
+            IT grow, gcol;
+            NT val;
+            const char * rec = buf.data() + i * elementsize;
+            std::memcpy(&grow, rec, sizeof(IT));
+            std::memcpy(&gcol, rec + sizeof(IT), sizeof(IT));
+            std::memcpy(&val, rec + 2*sizeof(IT), sizeof(NT));
+            rows.push_back(grow-1);     // binary format is 1-based
+            cols.push_back(gcol-1);
+            vals.push_back(val);
+        }
+        mybegin += count;
+        ExchangeTuplesChunk(rows, cols, vals, total_m, total_n, received);
+        int done = (mybegin == myend);
+        MPI_Allreduce(&done, &alldone, 1, MPI_INT, MPI_LAND, commGrid->GetWorld());
+    }
+    MPI_File_close(&thefile);
+
+    if(spSeq)   delete spSeq;
+    SparseFromTupleChunks(received, total_m, total_n, BinOp);
+}
+
+/**
+ * Checkpoints the matrix by writing the DCSC arrays of every local block as they are in memory
+ * Layout: BlockHeaderInfo, a directory of gridrows*gridcols BlockEntryInfo (row-major grid order), then the blocks,
+ * each as jc[nzc] cp[nzc+1] ir[nnz] numx[nnz] padded to a multiple of 8 bytes (nothing for an empty block)
+ * Every rank writes its directory entry and its arrays with one collective call each, without packing them
+ * Read back with ParallelBlockRead
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ParallelBlockWrite(const std::string & filename) const
+{
+    static_assert(std::is_trivially_copyable<NT>::value, "block checkpoints store numerical values as raw bytes");
+    typedef typename DER::LocalIT LIT;
+    int myrank = commGrid->GetRank();
+    int gridrows = commGrid->GetGridRows();
+    int gridcols = commGrid->GetGridCols();
+    if(spSeq->getnsplit() > 0)
+    {
+        SpParHelper::Print("ParallelBlockWrite does not support multithreaded (split) local matrices\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, INVALIDPARAMS);
+    }
+
+    BlockHeaderInfo header;
+    memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "CBDC", 4);
+    header.version = 1;
+    header.idxsize = sizeof(LIT);
+    header.objsize = sizeof(NT);
+    header.m = getnrow();
+    header.n = getncol();
+    header.nnz = getnnz();
+    header.gridrows = gridrows;
+    header.gridcols = gridcols;
+
+    BlockEntryInfo entry;
+    entry.m = spSeq->getnrow();
+    entry.n = spSeq->getncol();
+    entry.nnz = spSeq->getnnz();
+    Dcsc<LIT,NT> * dcsc = spSeq->GetDCSC();
+    entry.nzc = (entry.nnz > 0) ? dcsc->nzc : 0;
+
+    std::vector<const void *> addrs;
+    std::vector<int64_t> bytes;
+    if(entry.nnz > 0)
+    {
+        addrs = {dcsc->jc, dcsc->cp, dcsc->ir, dcsc->numx};
+        bytes = {static_cast<int64_t>(entry.nzc * sizeof(LIT)), static_cast<int64_t>((entry.nzc+1) * sizeof(LIT)),
+                static_cast<int64_t>(entry.nnz * sizeof(LIT)), static_cast<int64_t>(entry.nnz * sizeof(NT))};
+    }
+    int64_t localbytes = std::accumulate(bytes.begin(), bytes.end(), static_cast<int64_t>(0));
+    entry.bytes = localbytes;
+    localbytes = (localbytes + 7) / 8 * 8;  // keep the next block aligned
+
+    int64_t bytesuntil = 0;
+    MPI_Exscan(&localbytes, &bytesuntil, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+    if(myrank == 0) bytesuntil = 0;    // because MPI_Exscan says the recvbuf in process 0 is undefined
+    int64_t bytestotal;
+    MPI_Allreduce(&localbytes, &bytestotal, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+    int64_t dataoffset = sizeof(BlockHeaderInfo) + static_cast<int64_t>(gridrows) * gridcols * sizeof(BlockEntryInfo);
+    entry.offset = dataoffset + bytesuntil;
+    int slot = commGrid->GetRankInProcCol() * gridcols + commGrid->GetRankInProcRow();
+
+    MPI_File thefile;
+    MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile);
+    MPI_File_set_size(thefile, dataoffset + bytestotal);    // truncate any previous (larger) checkpoint
+    MPI_Status status;
+    if(myrank == 0)
+        MPI_File_write_at(thefile, 0, &header, sizeof(header), MPI_BYTE, &status);
+    MPI_File_write_at_all(thefile, sizeof(BlockHeaderInfo) + slot * sizeof(BlockEntryInfo), &entry, sizeof(entry), MPI_BYTE, &status);
+
+    MPI_Datatype memtype;
+    SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+    MPI_File_write_at_all(thefile, entry.offset, MPI_BOTTOM, (entry.nnz > 0) ? 1 : 0, memtype, &status);
+    MPI_Type_free(&memtype);
+    MPI_File_close(&thefile);
+}
+
+/**
+ * Restarts from a checkpoint written by ParallelBlockWrite
+ * If the processor grid has the shape of the saved one, every rank reads its directory entry and then its whole block,
+ * straight into the arrays of a newly allocated local matrix, with one collective MPI_File_read_at_all each
+ * Otherwise (e.g. a matrix saved on p1 x p1 processors loaded on p2 x p2), every rank reads only the saved blocks that
+ * overlap its new block: their jc/cp arrays and the ir/numx ranges of the overlapping columns, then it drops the rows
+ * outside its range and re-indexes locally. In neither case are triples communicated
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ParallelBlockRead(const std::string & filename)
+{
+    ++version;
+    typedef typename DER::LocalIT LIT;
+    int myrank = commGrid->GetRank();
+    int gridrows = commGrid->GetGridRows();
+    int gridcols = commGrid->GetGridCols();
+
+    MPI_File thefile;
+    if(MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+    {
+        SpParHelper::Print("COMBBLAS: Checkpoint file " + filename + " can not be opened\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, NOFILE);
+    }
+    MPI_Status status;
+    BlockHeaderInfo header;
+    if(myrank == 0)
+        MPI_File_read_at(thefile, 0, &header, sizeof(header), MPI_BYTE, &status);
+    MPI_Bcast(&header, sizeof(header), MPI_BYTE, 0, commGrid->GetWorld());
+    if(std::strncmp(header.magic, "CBDC", 4) != 0 || header.version != 1 || header.idxsize != sizeof(LIT) || header.objsize != sizeof(NT))
+    {
+        SpParHelper::Print("COMBBLAS: " + filename + " is not a block checkpoint of this matrix type\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, INVALIDPARAMS);
+    }
+    if(spSeq) delete spSeq;
+    mappedblock.reset();    // the old block may have been a view of a mapped checkpoint
+
+    if(header.gridrows == static_cast<uint64_t>(gridrows) && header.gridcols == static_cast<uint64_t>(gridcols))
+    {
+        int slot = commGrid->GetRankInProcCol() * gridcols + commGrid->GetRankInProcRow();
+        BlockEntryInfo entry;
+        MPI_File_read_at_all(thefile, sizeof(BlockHeaderInfo) + slot * sizeof(BlockEntryInfo), &entry, sizeof(entry), MPI_BYTE, &status);
+
+        spSeq = new DER(static_cast<LIT>(entry.nnz), static_cast<LIT>(entry.m), static_cast<LIT>(entry.n), static_cast<LIT>(entry.nzc));
+        std::vector<const void *> addrs;
+        std::vector<int64_t> bytes;
+        if(entry.nnz > 0)
+        {
+            Dcsc<LIT,NT> * dcsc = spSeq->GetDCSC();
+            addrs = {dcsc->jc, dcsc->cp, dcsc->ir, dcsc->numx};
+            bytes = {static_cast<int64_t>(entry.nzc * sizeof(LIT)), static_cast<int64_t>((entry.nzc+1) * sizeof(LIT)),
+                    static_cast<int64_t>(entry.nnz * sizeof(LIT)), static_cast<int64_t>(entry.nnz * sizeof(NT))};
+        }
+        MPI_Datatype memtype;
+        SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+        MPI_File_read_at_all(thefile, entry.offset, MPI_BOTTOM, (entry.nnz > 0) ? 1 : 0, memtype, &status);
+        MPI_Type_free(&memtype);
+        MPI_File_close(&thefile);
+        return;
+    }
+
+    // grid reshaping restart: find the saved blocks that overlap my block of the new grid
+    int oldrows = static_cast<int>(header.gridrows);
+    int oldcols = static_cast<int>(header.gridcols);
+    std::vector<BlockEntryInfo> directory(static_cast<size_t>(oldrows) * oldcols);
+    if(myrank == 0)
+        MPI_File_read_at(thefile, sizeof(BlockHeaderInfo), directory.data(), directory.size() * sizeof(BlockEntryInfo), MPI_BYTE, &status);
+    MPI_Bcast(directory.data(), directory.size() * sizeof(BlockEntryInfo), MPI_BYTE, 0, commGrid->GetWorld());
+
+    IT total_m = header.m;
+    IT total_n = header.n;
+    IT m_perproc = total_m / gridrows;
+    IT n_perproc = total_n / gridcols;
+    int myprocrow = commGrid->GetRankInProcCol();
+    int myproccol = commGrid->GetRankInProcRow();
+    IT rowbeg = myprocrow * m_perproc;
+    IT rowend = (myprocrow != gridrows-1) ? rowbeg + m_perproc : total_m;
+    IT colbeg = myproccol * n_perproc;
+    IT colend = (myproccol != gridcols-1) ? colbeg + n_perproc : total_n;
+    IT oldm_perproc = total_m / oldrows;
+    IT oldn_perproc = total_n / oldcols;
+
+    std::vector< std::tuple<LIT,LIT,NT> > tuples;
+    for(int i=0; i< oldrows; ++i)
+    {
+        IT oldrowbeg = i * oldm_perproc;
+        IT oldrowend = (i != oldrows-1) ? oldrowbeg + oldm_perproc : total_m;
+        if(oldrowend <= rowbeg || oldrowbeg >= rowend) continue;
+        for(int j=0; j< oldcols; ++j)
+        {
+            IT oldcolbeg = j * oldn_perproc;
+            IT oldcolend = (j != oldcols-1) ? oldcolbeg + oldn_perproc : total_n;
+            const BlockEntryInfo & entry = directory[static_cast<size_t>(i) * oldcols + j];
+            if(oldcolend <= colbeg || oldcolbeg >= colend || entry.nnz == 0) continue;
+
+            // jc and cp are adjacent in the file
+            std::vector<LIT> jccp(2 * entry.nzc + 1);
+            std::vector<const void *> addrs = {jccp.data()};
+            std::vector<int64_t> bytes = {static_cast<int64_t>(jccp.size() * sizeof(LIT))};
+            MPI_Datatype memtype;
+            SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+            MPI_File_read_at(thefile, entry.offset, MPI_BOTTOM, 1, memtype, &status);
+            MPI_Type_free(&memtype);
+            const LIT * jc = jccp.data();
+            const LIT * cp = jccp.data() + entry.nzc;
+
+            // nonzero columns of the saved block within [colbeg, colend), their nonzeros are contiguous
+            LIT lo = std::lower_bound(jc, jc + entry.nzc, static_cast<LIT>(std::max(colbeg, oldcolbeg) - oldcolbeg)) - jc;
+            LIT hi = std::lower_bound(jc, jc + entry.nzc, static_cast<LIT>(std::min(colend, oldcolend) - oldcolbeg)) - jc;
+            if(lo == hi) continue;
+            int64_t nzbeg = cp[lo] - cp[0];
+            int64_t nzcount = cp[hi] - cp[lo];
+            std::vector<LIT> ir(nzcount);
+            std::unique_ptr<NT[]> numx(new NT[nzcount]);
+            addrs = {ir.data()};
+            bytes = {static_cast<int64_t>(nzcount * sizeof(LIT))};
+            SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+            MPI_File_read_at(thefile, entry.offset + (2 * entry.nzc + 1 + nzbeg) * sizeof(LIT), MPI_BOTTOM, 1, memtype, &status);
+            MPI_Type_free(&memtype);
+            addrs = {numx.get()};
+            bytes = {static_cast<int64_t>(nzcount * sizeof(NT))};
+            SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+            MPI_File_read_at(thefile, entry.offset + (2 * entry.nzc + 1 + entry.nnz) * sizeof(LIT) + nzbeg * sizeof(NT), MPI_BOTTOM, 1, memtype, &status);
+            MPI_Type_free(&memtype);
+
+            for(LIT k = lo; k < hi; ++k)
+            {
+                LIT lcol = static_cast<LIT>(oldcolbeg + jc[k] - colbeg);
+                for(LIT p = cp[k]; p < cp[k+1]; ++p)
+                {
+                    IT grow = oldrowbeg + ir[p - cp[lo]];
+                    if(grow >= rowbeg && grow < rowend)
+                        tuples.push_back(std::make_tuple(static_cast<LIT>(grow - rowbeg), lcol, numx[p - cp[lo]]));
+                }
+            }
+        }
+    }
+    MPI_File_close(&thefile);
+
+    std::tuple<LIT,LIT,NT> * localtuples = new std::tuple<LIT,LIT,NT>[tuples.size()];
+    std::copy(tuples.begin(), tuples.end(), localtuples);
+    SpTuples<LIT,NT> A(tuples.size(), static_cast<LIT>(rowend - rowbeg), static_cast<LIT>(colend - colbeg), localtuples);	// It is ~SpTuples's job to deallocate
+    std::vector< std::tuple<LIT,LIT,NT> >().swap(tuples);
+    spSeq = new DER(A,false);
+}
+
+/**
+ * Loads a checkpoint written by ParallelBlockWrite by memory mapping every rank's block instead of reading it
+ * The local DCSC arrays point straight into a private (copy-on-write) mapping of the file: nothing is copied up front,
+ * pages are faulted in on first touch, and ranks on the same node share them through the page cache
+ * Meant for read-only analytics; operations that reallocate the local arrays copy them into owned memory first
+ * Falls back to ParallelBlockRead if the processor grid differs from the saved one or a block can not be mapped
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ParallelBlockMap(const std::string & filename)
+{
+    ++version;
+    static_assert(std::is_trivially_copyable<NT>::value, "block checkpoints store numerical values as raw bytes");
+    typedef typename DER::LocalIT LIT;
+    int gridrows = commGrid->GetGridRows();
+    int gridcols = commGrid->GetGridCols();
+
+    int canmap = 0;
+    BlockEntryInfo entry;
+    void * mapaddr = MAP_FAILED;
+    size_t maplen = 0;
+    int64_t mapbeg = 0;
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd >= 0)
+    {
+        BlockHeaderInfo header;
+        int slot = commGrid->GetRankInProcCol() * gridcols + commGrid->GetRankInProcRow();
+        if(pread(fd, &header, sizeof(header), 0) == sizeof(header) && std::strncmp(header.magic, "CBDC", 4) == 0 && header.version == 1 &&
+           header.idxsize == sizeof(LIT) && header.objsize == sizeof(NT) &&
+           header.gridrows == static_cast<uint64_t>(gridrows) && header.gridcols == static_cast<uint64_t>(gridcols) &&
+           pread(fd, &entry, sizeof(entry), sizeof(BlockHeaderInfo) + slot * sizeof(BlockEntryInfo)) == sizeof(entry))
+        {
+            // blocks start 8-byte aligned and the index arrays are packed, so only the values can be misaligned
+            uint64_t valoffset = entry.offset + (2*entry.nzc + 1 + entry.nnz) * sizeof(LIT);
+            if(entry.nnz == 0)
+                canmap = 1;
+            else if(valoffset % alignof(NT) == 0)
+            {
+                int64_t pagesize = sysconf(_SC_PAGESIZE);
+                mapbeg = entry.offset / pagesize * pagesize;
+                maplen = entry.offset + entry.bytes - mapbeg;
+                mapaddr = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, mapbeg);
+                canmap = (mapaddr != MAP_FAILED);
+            }
+        }
+        close(fd);    // an existing mapping stays valid
+    }
+    int allcanmap;
+    MPI_Allreduce(&canmap, &allcanmap, 1, MPI_INT, MPI_LAND, commGrid->GetWorld());
+    if(!allcanmap)
+    {
+        if(mapaddr != MAP_FAILED) munmap(mapaddr, maplen);
+        ParallelBlockRead(filename);    // also reports files that are not checkpoints
+        return;
+    }
+
+    if(spSeq) delete spSeq;
+    mappedblock.reset();
+    if(entry.nnz > 0)
+    {
+        mappedblock = std::shared_ptr<char>(static_cast<char*>(mapaddr), [maplen](char * p) { munmap(p, maplen); });
+        LIT * jc = reinterpret_cast<LIT*>(static_cast<char*>(mapaddr) + (entry.offset - mapbeg));
+        LIT * cp = jc + entry.nzc;
+        LIT * ir = cp + entry.nzc + 1;
+        NT * numx = reinterpret_cast<NT*>(ir + entry.nnz);
+        spSeq = new DER(static_cast<LIT>(entry.m), static_cast<LIT>(entry.n), static_cast<LIT>(entry.nnz), static_cast<LIT>(entry.nzc), cp, jc, ir, numx);
+    }
+    else
+    {
+        spSeq = new DER(0, static_cast<LIT>(entry.m), static_cast<LIT>(entry.n), 0);
+    }
+}
+
+/**
+ * Writes the matrix as a compressed edge file: an HKDT header with format 2, a CompressedHeaderInfo, a block index and
+ * the blocks (see CompressedBlockInfo). Every rank encodes its local columns, in column order, into blocks of about
+ * blocknnz nonzeros with global 0-based indices, so a 64-bit edge typically takes a few bytes instead of 16
+ * @param[in] withvalues {if false, values are not stored and read back as 1 (pattern matrices)}
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ParallelCompressedWrite(const std::string & filename, bool withvalues, IT blocknnz) const
+{
+    static_assert(std::is_trivially_copyable<NT>::value, "compressed edge files store numerical values as raw bytes");
+    int myrank = commGrid->GetRank();
+    uint64_t totalm = getnrow();
+    uint64_t totaln = getncol();
+    uint64_t totnnz = getnnz();
+    IT roffset = 0;
+    IT coffset = 0;
+    GetPlaceInGlobalGrid(roffset, coffset);
+
+    std::vector<uint8_t> localdata;
+    std::vector<CompressedBlockInfo> blocks;
+    std::vector<uint8_t> index;
+    std::vector<uint8_t> values;
+    std::vector< std::pair<IT,NT> > column;
+    uint64_t blockfirstcol = 0;
+    uint64_t prevcol = 0;
+    uint64_t blockentries = 0;
+    auto FinishBlock = [&]()
+    {
+        CompressedBlockInfo info;
+        info.firstcol = blockfirstcol;
+        info.nnz = blockentries;
+        info.offset = localdata.size();    // relative to this rank's data for now
+        uint64_t indexbytes = index.size();
+        localdata.insert(localdata.end(), reinterpret_cast<uint8_t*>(&indexbytes), reinterpret_cast<uint8_t*>(&indexbytes) + sizeof(uint64_t));
+        localdata.insert(localdata.end(), index.begin(), index.end());
+        localdata.insert(localdata.end(), values.begin(), values.end());
+        info.bytes = localdata.size() - info.offset;
+        blocks.push_back(info);
+        index.clear();
+        values.clear();
+        blockentries = 0;
+    };
+    for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)    // iterate over nonempty subcolumns
+    {
+        uint64_t glcolid = colit.colid() + coffset;
+        if(blockentries == 0)
+            blockfirstcol = prevcol = glcolid;
+        column.clear();
+        for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
+            column.push_back(std::make_pair(nzit.rowid() + roffset, nzit.value()));
+        if(!std::is_sorted(column.begin(), column.end(), [](const std::pair<IT,NT> & a, const std::pair<IT,NT> & b){ return a.first < b.first; }))
+            std::stable_sort(column.begin(), column.end(), [](const std::pair<IT,NT> & a, const std::pair<IT,NT> & b){ return a.first < b.first; });
+
+        SpHelper::EncodeVarint(glcolid - prevcol, index);
+        SpHelper::EncodeVarint(column.size(), index);
+        uint64_t prevrow = 0;
+        for(auto & nz : column)
+        {
+            SpHelper::EncodeVarint(static_cast<uint64_t>(nz.first) - prevrow, index);
+            prevrow = nz.first;
+            if(withvalues)
+                values.insert(values.end(), reinterpret_cast<const uint8_t*>(&nz.second), reinterpret_cast<const uint8_t*>(&nz.second) + sizeof(NT));
+        }
+        prevcol = glcolid;
+        blockentries += column.size();
+        if(blockentries >= static_cast<uint64_t>(blocknnz))
+            FinishBlock();
+    }
+    if(blockentries > 0)
+        FinishBlock();
+    std::vector< std::pair<IT,NT> >().swap(column);
+
+    int64_t localbytes = localdata.size();
+    int64_t localblocks = blocks.size();
+    int64_t bytesuntil = 0, blocksuntil = 0, totalblocks = 0, bytestotal = 0;
+    MPI_Exscan(&localbytes, &bytesuntil, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+    MPI_Exscan(&localblocks, &blocksuntil, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+    if(myrank == 0) bytesuntil = blocksuntil = 0;    // because MPI_Exscan says the recvbuf in process 0 is undefined
+    MPI_Allreduce(&localbytes, &bytestotal, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+    MPI_Allreduce(&localblocks, &totalblocks, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+
+    const int64_t headersize = 52; // 4 characters + 6*8 integer space, as in ParallelBinaryWrite
+    int64_t indexoffset = headersize + sizeof(CompressedHeaderInfo);
+    int64_t dataoffset = indexoffset + totalblocks * sizeof(CompressedBlockInfo);
+    for(auto & info : blocks)
+        info.offset += dataoffset + bytesuntil;
+
+    MPI_File thefile;
+    MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile);
+    MPI_File_set_size(thefile, dataoffset + bytestotal);    // truncate any previous (larger) file
+    MPI_Status status;
+    if(myrank == 0)
+    {
+        char header[headersize + sizeof(CompressedHeaderInfo)];
+        uint64_t hdr[6];
+        hdr[0] = 2;    // version: 2.0
+        hdr[1] = withvalues ? sizeof(NT) : 0;   // object size
+        hdr[2] = 2;    // format: compressed binary
+        hdr[3] = totalm;
+        hdr[4] = totaln;
+        hdr[5] = totnnz;
+        CompressedHeaderInfo chdr;
+        chdr.nblocks = totalblocks;
+        chdr.valuecodec = withvalues ? 1 : 0;
+        std::memcpy(header, "HKDT", 4);
+        std::memcpy(header+4, hdr, sizeof(hdr));
+        std::memcpy(header+headersize, &chdr, sizeof(chdr));
+        MPI_File_write_at(thefile, 0, header, sizeof(header), MPI_BYTE, &status);
+    }
+    std::vector<const void *> addrs = {blocks.data()};
+    std::vector<int64_t> bytes = {static_cast<int64_t>(blocks.size() * sizeof(CompressedBlockInfo))};
+    MPI_Datatype memtype;
+    SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+    MPI_File_write_at_all(thefile, indexoffset + blocksuntil * sizeof(CompressedBlockInfo), MPI_BOTTOM, 1, memtype, &status);
+    MPI_Type_free(&memtype);
+
+    addrs = {localdata.data()};
+    bytes = {localbytes};
+    SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+    MPI_File_write_at_all(thefile, dataoffset + bytesuntil, MPI_BOTTOM, 1, memtype, &status);
+    MPI_Type_free(&memtype);
+    MPI_File_close(&thefile);
+}
+
+/**
+ * Reads a compressed edge file written by ParallelCompressedWrite (also called by ReadDistribute for such files)
+ * Blocks are assigned to ranks in contiguous ranges of roughly equal nonzero counts; every rank fetches its range with
+ * one collective read and decodes its blocks in parallel (THREADED), then the edges are sent to their owners
+ * @param[in] BinOp {combines the values of duplicate entries}
+ */
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat< IT,NT,DER >::ParallelCompressedRead(const std::string & filename, _BinaryOperation BinOp, bool transpose)
+{
+    static_assert(std::is_trivially_copyable<NT>::value, "compressed edge files store numerical values as raw bytes");
+    typedef typename DER::LocalIT LIT;
+    int myrank = commGrid->GetRank();
+    int nprocs = commGrid->GetSize();
+    const int64_t headersize = 52;
+
+    MPI_File thefile;
+    if(MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+    {
+        SpParHelper::Print("COMBBLAS: Input file " + filename + " can not be opened\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, NOFILE);
+    }
+    MPI_Status status;
+    char header[headersize + sizeof(CompressedHeaderInfo)];
+    if(myrank == 0)
+        MPI_File_read_at(thefile, 0, header, sizeof(header), MPI_BYTE, &status);
+    MPI_Bcast(header, sizeof(header), MPI_BYTE, 0, commGrid->GetWorld());
+    uint64_t hdr[6];
+    CompressedHeaderInfo chdr;
+    std::memcpy(hdr, header+4, sizeof(hdr));
+    std::memcpy(&chdr, header+headersize, sizeof(chdr));
+    if(std::strncmp(header, "HKDT", 4) != 0 || hdr[2] != 2 || chdr.valuecodec > 1 || (chdr.valuecodec == 1 && hdr[1] != sizeof(NT)))
+    {
+        SpParHelper::Print("COMBBLAS: " + filename + " is not a compressed edge file of this matrix type\n", commGrid->GetWorld());
+        MPI_Abort(MPI_COMM_WORLD, INVALIDPARAMS);
+    }
+    IT total_m = transpose ? hdr[4] : hdr[3];
+    IT total_n = transpose ? hdr[3] : hdr[4];
+    int64_t indexoffset = headersize + sizeof(CompressedHeaderInfo);
+
+    std::vector<CompressedBlockInfo> blocks(chdr.nblocks);
+    std::vector<const void *> addrs = {blocks.data()};
+    std::vector<int64_t> bytes = {static_cast<int64_t>(blocks.size() * sizeof(CompressedBlockInfo))};
+    MPI_Datatype memtype;
+    SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+    if(myrank == 0)
+        MPI_File_read_at(thefile, indexoffset, MPI_BOTTOM, 1, memtype, &status);
+    MPI_Bcast(MPI_BOTTOM, 1, memtype, 0, commGrid->GetWorld());
+    MPI_Type_free(&memtype);
+
+    // my blocks: those whose first nonzero falls into my share of the nonzeros
+    uint64_t nnzsofar = 0;
+    size_t firstblock = blocks.size(), lastblock = blocks.size();
+    for(size_t b=0; b< blocks.size(); ++b)
+    {
+        int owner = static_cast<int>(std::min(static_cast<uint64_t>(nprocs-1), (nnzsofar * nprocs) / std::max(hdr[5], static_cast<uint64_t>(1))));
+        if(owner == myrank && firstblock == blocks.size()) firstblock = b;
+        if(owner > myrank) { lastblock = b; break; }
+        nnzsofar += blocks[b].nnz;
+    }
+    if(firstblock == blocks.size()) lastblock = firstblock;
+    int64_t mybytes = 0;
+    int64_t myoffset = 0;
+    if(firstblock < lastblock)
+    {
+        myoffset = blocks[firstblock].offset;
+        mybytes = blocks[lastblock-1].offset + blocks[lastblock-1].bytes - myoffset;
+    }
+    std::vector<uint8_t> mydata(mybytes);
+    addrs = {mydata.data()};
+    bytes = {mybytes};
+    SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+    MPI_File_read_at_all(thefile, myoffset, MPI_BOTTOM, (mybytes > 0) ? 1 : 0, memtype, &status);
+    MPI_Type_free(&memtype);
+    MPI_File_close(&thefile);
+
+    int nthreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+    {
+        nthreads = omp_get_num_threads();
+    }
+#endif
+    std::vector< std::vector< std::vector< std::tuple<LIT,LIT,NT> > > > tdata(nthreads, std::vector< std::vector< std::tuple<LIT,LIT,NT> > >(nprocs));
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(size_t b=firstblock; b < lastblock; ++b)
+    {
+        int myThread = 0;
+#ifdef THREADED
+        myThread = omp_get_thread_num();
+#endif
+        std::vector< std::vector< std::tuple<LIT,LIT,NT> > > & mydata_t = tdata[myThread];
+        const uint8_t * block = mydata.data() + (blocks[b].offset - myoffset);
+        uint64_t indexbytes;
+        std::memcpy(&indexbytes, block, sizeof(uint64_t));
+        const uint8_t * p = block + sizeof(uint64_t);
+        const uint8_t * vals = p + indexbytes;
+        uint64_t col = blocks[b].firstcol;
+        uint64_t k = 0;
+        while(k < blocks[b].nnz)
+        {
+            uint64_t delta, count, row = 0;
+            p = SpHelper::DecodeVarint(p, delta);
+            col += delta;
+            p = SpHelper::DecodeVarint(p, count);
+            for(uint64_t c=0; c< count; ++c, ++k)
+            {
+                p = SpHelper::DecodeVarint(p, delta);
+                row += delta;
+                NT val;
+                if(chdr.valuecodec == 1)
+                    std::memcpy(&val, vals + k * sizeof(NT), sizeof(NT));
+                else
+                    val = static_cast<NT>(1);
+                LIT lrow, lcol;
+                int owner = transpose ? Owner(total_m, total_n, col, row, lrow, lcol) : Owner(total_m, total_n, row, col, lrow, lcol);
+                mydata_t[owner].push_back(std::make_tuple(lrow, lcol, val));
+            }
+        }
+    }
+    std::vector<uint8_t>().swap(mydata);
+
+    std::vector< std::vector < std::tuple<LIT,LIT,NT> > > data(nprocs);
+    LIT locsize = 0;
+    for(int i=0; i< nprocs; ++i)
+    {
+        for(int t=0; t< nthreads; ++t)
+        {
+            data[i].insert(data[i].end(), tdata[t][i].begin(), tdata[t][i].end());
+            std::vector< std::tuple<LIT,LIT,NT> >().swap(tdata[t][i]);
+        }
+        locsize += data[i].size();
+    }
+    if(spSeq)   delete spSeq;
+    SparseCommon(data, locsize, total_m, total_n, BinOp);
+}
+
+/**
+ * Generates an R-MAT (Kronecker) graph in place, without an edge list and without any communication.
+ * The 2^scale-by-2^scale adjacency matrix is split recursively into quadrants, and the edgefactor*2^scale
+ * edges of each quadrant are divided among its four children by a multinomial draw with the initiator
+ * probabilities {a,b,c,d} = {top left, top right, bottom left, bottom right}. Every draw comes from a counter
+ * based random stream named by the quadrant itself, so all processors agree on the split of any quadrant
+ * without talking, and each one only descends into the quadrants that overlap its own block.
+ * The matrix is therefore the same for any process grid and thread count (given the seed).
+ * Duplicate edges are summed (as in the DistEdgeList constructor) and the vertices are not relabeled,
+ * so the blocks inherit the skew of R-MAT; permute afterwards if the application needs balanced blocks
+ * @param[in] initiator {probabilities of the four quadrants, normalized to sum to one}
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::GenerateRMAT(int scale, int edgefactor, const double initiator[4], uint64_t seed, bool removeloops)
+{
+	typedef typename DER::LocalIT LIT;
+	double total = initiator[0] + initiator[1] + initiator[2] + initiator[3];
+	if(scale < 0 || scale > 62 || edgefactor < 0 || !(total > 0))
+	{
+		SpParHelper::Print("COMBBLAS: Invalid R-MAT parameters\n", commGrid->GetWorld());
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	double prob[4];
+	for(int q=0; q< 4; ++q) prob[q] = initiator[q] / total;
+
+	IT nverts = static_cast<IT>(1) << scale;
+	int gridrows = commGrid->GetGridRows();
+	int gridcols = commGrid->GetGridCols();
+	int myprocrow = commGrid->GetRankInProcCol();
+	int myproccol = commGrid->GetRankInProcRow();
+	IT m_perproc = nverts / gridrows;
+	IT n_perproc = nverts / gridcols;
+	IT rowlo = myprocrow * m_perproc;
+	IT collo = myproccol * n_perproc;
+	IT rowhi = (myprocrow != gridrows-1) ? (rowlo + m_perproc) : nverts;
+	IT colhi = (myproccol != gridcols-1) ? (collo + n_perproc) : nverts;
+
+	struct Quadrant
+	{
+		int level;		// the quadrant spans 2^(scale-level) rows and columns
+		IT row;
+		IT col;
+		uint64_t edges;
+		uint64_t key;		// names its random stream
+	};
+	auto overlaps = [&](const Quadrant & quad)
+	{
+		IT size = static_cast<IT>(1) << (scale - quad.level);
+		return (quad.row < rowhi && quad.row + size > rowlo && quad.col < colhi && quad.col + size > collo);
+	};
+	auto split = [&](const Quadrant & quad, std::vector<Quadrant> & children)
+	{
+		uint64_t counter = 0;
+		uint64_t rest = quad.edges;
+		double restprob = 1.0;
+		IT half = static_cast<IT>(1) << (scale - quad.level - 1);
+		for(int q=0; q< 4; ++q)
+		{
+			uint64_t edges = rest;
+			if(q < 3)
+			{
+				edges = SpHelper::CounterBinomial(rest, (restprob > 0) ? (prob[q] / restprob) : 1.0, quad.key, counter);
+				rest -= edges;
+				restprob -= prob[q];
+			}
+			Quadrant child = {quad.level+1, quad.row + (q/2)*half, quad.col + (q%2)*half, edges, SpHelper::CounterMix(quad.key ^ (q+1))};
+			if(edges > 0 && overlaps(child))
+				children.push_back(child);
+		}
+	};
+
+	// expand breadth first until there are enough independent subtrees to keep the threads busy
+	int nthreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+	{
+		nthreads = omp_get_num_threads();
+	}
+#endif
+	Quadrant root = {0, 0, 0, static_cast<uint64_t>(edgefactor) << scale, SpHelper::CounterMix(seed)};
+	std::vector<Quadrant> frontier;
+	if(root.edges > 0 && overlaps(root))
+		frontier.push_back(root);
+	while(!frontier.empty() && frontier.size() < 16 * static_cast<size_t>(nthreads) && frontier[0].level < scale)
+	{
+		std::vector<Quadrant> next;
+		for(auto & quad: frontier)
+			split(quad, next);
+		frontier.swap(next);
+	}
+
+	std::vector< std::vector< std::tuple<LIT,LIT,NT> > > tdata(nthreads);
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(size_t i=0; i< frontier.size(); ++i)
+	{
+		int myThread = 0;
+#ifdef THREADED
+		myThread = omp_get_thread_num();
+#endif
+		std::vector<Quadrant> stack(1, frontier[i]);
+		while(!stack.empty())
+		{
+			Quadrant quad = stack.back();
+			stack.pop_back();
+			if(quad.level == scale)		// a single entry, whose value is the number of edges that fell on it
+			{
+				if(!removeloops || quad.row != quad.col)
+					tdata[myThread].push_back(std::make_tuple(static_cast<LIT>(quad.row - rowlo), static_cast<LIT>(quad.col - collo), static_cast<NT>(quad.edges)));
+			}
+			else
+			{
+				split(quad, stack);
+			}
+		}
+	}
+
+	size_t ntuples = 0;
+	for(int t=0; t< nthreads; ++t)
+		ntuples += tdata[t].size();
+	std::tuple<LIT,LIT,NT> * localtuples = new std::tuple<LIT,LIT,NT>[ntuples];
+	size_t offset = 0;
+	for(int t=0; t< nthreads; ++t)
+	{
+		std::copy(tdata[t].begin(), tdata[t].end(), localtuples + offset);
+		offset += tdata[t].size();
+		std::vector< std::tuple<LIT,LIT,NT> >().swap(tdata[t]);
+	}
+	if(spSeq)   delete spSeq;
+	SparseFromTuples(localtuples, static_cast<LIT>(ntuples), nverts, nverts, std::plus<NT>());	// leaves are distinct, nothing is combined
+}
+
 template <class IT, class NT, class DER>
 SpParMat< IT,NT,DER >::SpParMat (const SpParMat< IT,NT,DER > & rhs)
 {
@@ -724,11 +1533,14 @@ SpParMat< IT,NT,DER >::SpParMat (const SpParMat< IT,NT,DER > & rhs)
 template <class IT, class NT, class DER>
 SpParMat< IT,NT,DER > & SpParMat< IT,NT,DER >::operator=(const SpParMat< IT,NT,DER > & rhs)
 {
+	++version;
 	if(this != &rhs)		
 	{
 		//! Check agains NULL is probably unneccessary, delete won't fail on NULL
 		//! But useful in the presence of a user defined "operator delete" which fails to check NULL
 		if(spSeq != NULL) delete spSeq;
+		mappedblock.reset();
+		ReleaseViews();
 		if(rhs.spSeq != NULL)	
 			spSeq = new DER(*(rhs.spSeq));  // Deep copy of local block
 	
@@ -740,6 +1552,7 @@ SpParMat< IT,NT,DER > & SpParMat< IT,NT,DER >::operator=(const SpParMat< IT,NT,D
 template <class IT, class NT, class DER>
 SpParMat< IT,NT,DER > & SpParMat< IT,NT,DER >::operator+=(const SpParMat< IT,NT,DER > & rhs)
 {
+	++version;
 	if(this != &rhs)		
 	{
 		if(*commGrid == *rhs.commGrid)	
@@ -800,6 +1613,7 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>	
 void SpParMat<IT,NT,DER>::DimApply(Dim dim, const FullyDistVec<IT, NT>& x, _BinaryOperation __binary_op)
 {
+	++version;
 
 	if(!(*commGrid == *(x.commGrid))) 		
 	{
@@ -2029,6 +2843,7 @@ template <class IT, class NT, class DER>
 template <typename PTNTBOOL, typename PTBOOLNT>
 SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::SubsRef_SR (const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci, bool inplace)
 {
+	if(inplace) ++version;
 	typedef typename DER::LocalIT LIT;
 
 	// infer the concrete type SpMat<LIT,LIT>
@@ -2119,14 +2934,14 @@ SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::SubsRef_SR (const FullyDistVec<IT,IT> &
 		std::copy(rowid[i].begin(), rowid[i].end(), senddata+sdispls[i]);
 		std::vector<IT>().swap(rowid[i]);	// clear memory of rowid
 	}
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), p_rows, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), p_rows, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
 
 	for(int i=0; i<rowneighs; ++i)
 	{
 		std::copy(colid[i].begin(), colid[i].end(), senddata+sdispls[i]);
 		std::vector<IT>().swap(colid[i]);	// clear memory of colid
 	}
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), p_cols, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), p_cols, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
 	delete [] senddata;
 
 	std::tuple<LIT,LIT,bool> * p_tuples = new std::tuple<LIT,LIT,bool>[p_nnz]; 
@@ -2219,14 +3034,14 @@ SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::SubsRef_SR (const FullyDistVec<IT,IT> &
 		std::copy(rowid[i].begin(), rowid[i].end(), senddata+sdispls[i]);
 		std::vector<IT>().swap(rowid[i]);	// clear memory of rowid
 	}
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), q_rows, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), q_rows, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
 
 	for(int i=0; i<rowneighs; ++i)
 	{
 		std::copy(colid[i].begin(), colid[i].end(), senddata+sdispls[i]);
 		std::vector<IT>().swap(colid[i]);	// clear memory of colid
 	}
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), q_cols, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(), q_cols, recvcnt, rdispls, MPIType<IT>(), commGrid->GetRowWorld());
 	DeleteAll(senddata, sendcnt, recvcnt, sdispls, rdispls);
 
 	std::tuple<LIT,LIT,bool> * q_tuples = new std::tuple<LIT,LIT,bool>[q_nnz]; 	// here we can convert to local indices (2018 note by Aydin)
@@ -2269,6 +3084,7 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 	bool inplace
 	)
 {
+	if(inplace) ++version;
 	typedef typename DER::LocalIT LIT;
 	typedef typename create_trait<DER, LIT, bool>::T_inferred DER_IT;
 
@@ -2365,7 +3181,7 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 		std::vector<IT>().swap(rowid[i]);	// free memory
 	}
 
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(),
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(),
 				  v_rows, recvcnt, rdispls, MPIType<IT>(),
 				  commGrid->GetRowWorld());
 
@@ -2375,7 +3191,7 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 		std::vector<IT>().swap(colid[i]);	// free memory
 	}
 
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(),
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPIType<IT>(),
 				  v_cols, recvcnt, rdispls, MPIType<IT>(),
 				  commGrid->GetRowWorld());
 
@@ -2435,6 +3251,7 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::SpAsgn(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci, SpParMat<IT,NT,DER> & B)
 {
+	++version;
 	typedef PlusTimesSRing<NT, NT> PTRing;
 	
 	if((*(ri.commGrid) != *(B.commGrid)) || (*(ci.commGrid) != *(B.commGrid)))
@@ -2483,6 +3300,7 @@ void SpParMat<IT,NT,DER>::SpAsgn(const FullyDistVec<IT,IT> & ri, const FullyDist
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::Prune(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci)
 {
+	++version;
 	if((*(ri.commGrid) != *(commGrid)) || (*(ci.commGrid) != *(commGrid)))
 	{
 		SpParHelper::Print("Grids are not comparable, Prune fails!\n", commGrid->GetWorld());
@@ -2532,6 +3350,7 @@ void SpParMat<IT,NT,DER>::Prune(const FullyDistVec<IT,IT> & ri, const FullyDistV
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::PruneFull(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci)
 {
+	++version;
 	if((*(ri.commGrid) != *(commGrid)) || (*(ci.commGrid) != *(commGrid)))
 	{
 		SpParHelper::Print("Grids are not comparable, Prune fails!\n", commGrid->GetWorld());
@@ -2577,6 +3396,7 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>
 SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::PruneColumn(const FullyDistVec<IT,NT> & pvals, _BinaryOperation __binary_op, bool inPlace)
 {
+    if(inPlace) ++version;
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
     //MPI_Barrier(MPI_COMM_WORLD);
@@ -2659,6 +3479,7 @@ template <class IT, class NT, class DER>
 template <class IRRELEVANT_NT>
 void SpParMat<IT,NT,DER>::PruneColumnByIndex(const FullyDistSpVec<IT,IRRELEVANT_NT>& ci)
 {
+    ++version;
     MPI_Comm World = ci.commGrid->GetWorld();
     MPI_Barrier(World);
 
@@ -2721,6 +3542,7 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>
 SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::PruneColumn(const FullyDistSpVec<IT,NT> & pvals, _BinaryOperation __binary_op, bool inPlace)
 {
+    if(inPlace) ++version;
     //MPI_Barrier(MPI_COMM_WORLD);
     MPI_Comm World = pvals.commGrid->GetWorld();
     MPI_Barrier(World);
@@ -2793,6 +3615,7 @@ SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::PruneColumn(const FullyDistSpVec<IT,NT>
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::EWiseMult (const SpParMat< IT,NT,DER >  & rhs, bool exclude)
 {
+	++version;
 	if(*commGrid == *rhs.commGrid)	
 	{
 		spSeq->EWiseMult(*(rhs.spSeq), exclude);		// Dimension compatibility check performed by sequential function
@@ -2814,6 +3637,7 @@ void SpParMat<IT,NT,DER>::EWiseMult (const SpParMat< IT,NT,DER >  & rhs, bool ex
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::SetDifference(const SpParMat<IT,NT,DER> & rhs)
 {
+	++version;
 	if(*commGrid == *rhs.commGrid)	
 	{
 		spSeq->SetDifference(*(rhs.spSeq));		// Dimension compatibility check performed by sequential function
@@ -2829,6 +3653,7 @@ void SpParMat<IT,NT,DER>::SetDifference(const SpParMat<IT,NT,DER> & rhs)
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::EWiseScale(const DenseParMat<IT, NT> & rhs)
 {
+	++version;
 	if(*commGrid == *rhs.commGrid)	
 	{
 		spSeq->EWiseScale(rhs.array, rhs.m, rhs.n);	// Dimension compatibility check performed by sequential function
@@ -2906,6 +3731,7 @@ template <typename _BinaryOperation, typename LIT>
 void SpParMat< IT,NT,DER >::SparseCommon(std::vector< std::vector < std::tuple<LIT,LIT,NT> > > & data, LIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp)
 //void SpParMat< IT,NT,DER >::SparseCommon(std::vector< std::vector < std::tuple<typename DER::LocalIT,typename DER::LocalIT,NT> > > & data, typename DER::LocalIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp)
 {
+    ++version;
     //typedef typename DER::LocalIT LIT;
 	int nprocs = commGrid->GetSize();
 	int * sendcnt = new int[nprocs];
@@ -2955,11 +3781,21 @@ void SpParMat< IT,NT,DER >::SparseCommon(std::vector< std::vector < std::tuple<L
 	MPI_Type_commit(&MPI_triple);
 
 	std::tuple<LIT,LIT,NT> * recvdata = new std::tuple<LIT,LIT,NT>[totrecv];	
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPI_triple, recvdata, recvcnt, rdispls, MPI_triple, commGrid->GetWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, MPI_triple, recvdata, recvcnt, rdispls, MPI_triple, commGrid->GetWorld());
 
 	DeleteAll(senddata, sendcnt, recvcnt, sdispls, rdispls);
 	MPI_Type_free(&MPI_triple);
 
+	SparseFromTuples(recvdata, static_cast<LIT>(totrecv), total_m, total_n, BinOp);
+}
+
+//! Builds the local matrix from tuples (in local indices) that are already on their owner
+//! Takes ownership of localtuples, which must have been allocated with new[]
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation, typename LIT>
+void SpParMat< IT,NT,DER >::SparseFromTuples(std::tuple<LIT,LIT,NT> * localtuples, LIT ntuples, IT total_m, IT total_n, _BinaryOperation BinOp)
+{
+	++version;
 	int r = commGrid->GetGridRows();
 	int s = commGrid->GetGridCols();
 	IT m_perproc = total_m / r;
@@ -2972,12 +3808,82 @@ void SpParMat< IT,NT,DER >::SparseCommon(std::vector< std::vector < std::tuple<L
 	if(myproccol != s-1)	loccols = n_perproc;
 	else	loccols = total_n - myproccol * n_perproc;
     
-	SpTuples<LIT,NT> A(totrecv, locrows, loccols, recvdata);	// It is ~SpTuples's job to deallocate
+	SpTuples<LIT,NT> A(ntuples, locrows, loccols, localtuples);	// It is ~SpTuples's job to deallocate
 	
     	// the previous constructor sorts based on columns-first (but that doesn't matter as long as they are sorted one way or another)
     	A.RemoveDuplicates(BinOp);
 	
   	spSeq = new DER(A,false);        // Convert SpTuples to DER
+	mappedblock.reset();
+}
+
+//! Builds the local matrix from the chunks received by ExchangeTuplesChunk
+//! The chunks are moved into one exactly sized array one at a time, so only one of them is ever held twice
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation, typename LIT>
+void SpParMat< IT,NT,DER >::SparseFromTupleChunks(std::vector< std::vector< std::tuple<LIT,LIT,NT> > > & chunks, IT total_m, IT total_n, _BinaryOperation BinOp)
+{
+	size_t ntuples = 0;
+	for(size_t i=0; i< chunks.size(); ++i)
+		ntuples += chunks[i].size();
+	std::tuple<LIT,LIT,NT> * localtuples = new std::tuple<LIT,LIT,NT>[ntuples];
+	size_t offset = 0;
+	for(size_t i=0; i< chunks.size(); ++i)
+	{
+		std::copy(chunks[i].begin(), chunks[i].end(), localtuples + offset);
+		offset += chunks[i].size();
+		std::vector< std::tuple<LIT,LIT,NT> >().swap(chunks[i]);
+	}
+	chunks.clear();
+	SparseFromTuples(localtuples, static_cast<LIT>(ntuples), total_m, total_n, BinOp);
+}
+
+/**
+ * One round of streaming ingestion: sends the entries in rows/cols/vals (global indices) to their owners and
+ * appends the entries this rank receives, in local indices, to chunks as one exactly sized chunk. rows/cols/vals are
+ * cleared but keep their capacity for the next round. Collective; ranks that ran out of input still have to call it
+ * (with empty vectors)
+ */
+template <class IT, class NT, class DER>
+template <typename LIT>
+void SpParMat< IT,NT,DER >::ExchangeTuplesChunk(std::vector<IT> & rows, std::vector<IT> & cols, std::vector<NT> & vals, IT total_m, IT total_n, std::vector< std::vector< std::tuple<LIT,LIT,NT> > > & chunks)
+{
+	int nprocs = commGrid->GetSize();
+	size_t nentries = rows.size();
+	std::vector<int> owners(nentries);
+	std::vector<int> sendcnt(nprocs, 0);
+	std::vector<int> recvcnt(nprocs);
+	for(size_t i=0; i< nentries; ++i)
+	{
+		LIT lrow, lcol;
+		owners[i] = Owner(total_m, total_n, rows[i], cols[i], lrow, lcol);
+		rows[i] = lrow;		// global indices are not needed anymore
+		cols[i] = lcol;
+		++sendcnt[owners[i]];
+	}
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, commGrid->GetWorld());
+	std::vector<int> sdispls(nprocs, 0);
+	std::vector<int> rdispls(nprocs, 0);
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	size_t totrecv = std::accumulate(recvcnt.begin(), recvcnt.end(), static_cast<size_t>(0));
+
+	std::vector< std::tuple<LIT,LIT,NT> > senddata(nentries);
+	std::vector<int> curptrs(sdispls);
+	for(size_t i=0; i< nentries; ++i)
+		senddata[curptrs[owners[i]]++] = std::make_tuple(static_cast<LIT>(rows[i]), static_cast<LIT>(cols[i]), static_cast<NT>(vals[i]));
+	rows.clear();
+	cols.clear();
+	vals.clear();
+
+	std::vector< std::tuple<LIT,LIT,NT> > recvdata(totrecv);
+	MPI_Datatype MPI_triple;
+	MPI_Type_contiguous(sizeof(std::tuple<LIT,LIT,NT>), MPI_CHAR, &MPI_triple);
+	MPI_Type_commit(&MPI_triple);
+	SpParHelper::Alltoallv(senddata.data(), sendcnt.data(), sdispls.data(), MPI_triple, recvdata.data(), recvcnt.data(), rdispls.data(), MPI_triple, commGrid->GetWorld());
+	MPI_Type_free(&MPI_triple);
+	if(totrecv > 0)
+		chunks.push_back(std::move(recvdata));
 }
 
 
@@ -3248,7 +4154,7 @@ SpParMat< IT,NT,DER >::SpParMat (const DistEdgeList<DELIT> & DEL, bool removeloo
 		LIT * recvbuf = new LIT[thisrecv];
 		totrecv += thisrecv;
 			
-		MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<LIT>(), recvbuf, recvcnt, rdispls, MPIType<LIT>(), commGrid->GetWorld());
+		SpParHelper::Alltoallv(sendbuf, sendcnt, sdispls, MPIType<LIT>(), recvbuf, recvcnt, rdispls, MPIType<LIT>(), commGrid->GetWorld());
 		DeleteAll(sendcnt, recvcnt, sdispls, rdispls,sendbuf);
     std::copy (recvbuf,recvbuf+thisrecv,std::back_inserter(alledges));	// copy to all edges
 		delete [] recvbuf;
@@ -3269,6 +4175,7 @@ SpParMat< IT,NT,DER >::SpParMat (const DistEdgeList<DELIT> & DEL, bool removeloo
 template <class IT, class NT, class DER>
 IT SpParMat<IT,NT,DER>::RemoveLoops()
 {
+	++version;
 	MPI_Comm DiagWorld = commGrid->GetDiagWorld();
 	IT totrem;
 	IT removed = 0;
@@ -3279,6 +4186,7 @@ IT SpParMat<IT,NT,DER>::RemoveLoops()
 		delete spSeq;
 		removed  = tuples.RemoveLoops();
 		spSeq = new DER(tuples, false);	// Convert to DER
+		mappedblock.reset();
 	}
 	MPI_Allreduce( &removed, & totrem, 1, MPIType<IT>(), MPI_SUM, commGrid->GetWorld());
 	return totrem;
@@ -3289,6 +4197,7 @@ IT SpParMat<IT,NT,DER>::RemoveLoops()
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::AddLoops(NT loopval, bool replaceExisting)
 {
+	++version;
 	MPI_Comm DiagWorld = commGrid->GetDiagWorld();
 	if(DiagWorld != MPI_COMM_NULL) // Diagonal processors only
 	{
@@ -3298,6 +4207,7 @@ void SpParMat<IT,NT,DER>::AddLoops(NT loopval, bool replaceExisting)
 		tuples.AddLoops(loopval, replaceExisting);
         	tuples.SortColBased();
 		spSeq = new DER(tuples, false);	// Convert to DER
+		mappedblock.reset();
 	}
 }
 
@@ -3306,6 +4216,7 @@ void SpParMat<IT,NT,DER>::AddLoops(NT loopval, bool replaceExisting)
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::AddLoops(FullyDistVec<IT,NT> loopvals, bool replaceExisting)
 {
+    ++version;
     
     
     if(*loopvals.commGrid != *commGrid)
@@ -3344,6 +4255,7 @@ void SpParMat<IT,NT,DER>::AddLoops(FullyDistVec<IT,NT> loopvals, bool replaceExi
         tuples.AddLoops(rowvals, replaceExisting);
         tuples.SortColBased();
         spSeq = new DER(tuples, false);	// Convert to DER
+        mappedblock.reset();
     }
 }
 
@@ -3468,6 +4380,7 @@ template <class IT, class NT, class DER>
 template <typename SR>
 void SpParMat<IT,NT,DER>::Square ()
 {
+	++version;
 	int stages, dummy; 	// last two parameters of productgrid are ignored for synchronous multiplication
 	std::shared_ptr<CommGrid> Grid = ProductGrid(commGrid.get(), commGrid.get(), stages, dummy, dummy);		
 
@@ -3532,6 +4445,7 @@ void SpParMat<IT,NT,DER>::Square ()
 	
 	delete spSeq;		
 	spSeq = new DER(MergeAll<SR>(tomerge, AA_m, AA_n), false);	// First get the result in SpTuples, then convert to UDER
+	mappedblock.reset();
 	for(unsigned int i=0; i<tomerge.size(); ++i)
 		delete tomerge[i];
 }
@@ -3540,61 +4454,110 @@ void SpParMat<IT,NT,DER>::Square ()
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::Transpose()
 {
+	++version;
+	if(transposeview && transposeversion == version-1)	// the cached transpose is current: swap it in, and keep the old matrix as the new one's transpose
+	{
+		std::swap(spSeq, transposeview->spSeq);
+		std::swap(mappedblock, transposeview->mappedblock);
+		transposeview->Touch();
+		transposeversion = version;
+		return;
+	}
 	if(commGrid->myproccol == commGrid->myprocrow)	// Diagonal
 	{
 		spSeq->Transpose();			
 	}
 	else
 	{
+		// Pack the local block into a single buffer, compressed by columns: [m, n, nnz, nzc | jc | cp | ir | (padding) num]
 		typedef typename DER::LocalIT LIT;
-		SpTuples<LIT,NT> Atuples(*spSeq);
-		LIT locnnz = Atuples.getnnz();
-		LIT * rows = new LIT[locnnz];
-		LIT * cols = new LIT[locnnz];
-		NT * vals = new NT[locnnz];
-		for(LIT i=0; i < locnnz; ++i)
+		LIT locm = getlocalrows();
+		LIT locn = getlocalcols();
+		LIT locnnz = spSeq->getnnz();
+		LIT locnzc = 0;
+		for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)
+			if(colit.nnz() > 0)	++locnzc;
+
+		auto valoffset = [](LIT nnz, LIT nzc)	// byte offset of the values, aligned for NT
 		{
-			rows[i] = Atuples.colindex(i);	// swap (i,j) here
-			cols[i] = Atuples.rowindex(i);
-			vals[i] = Atuples.numvalue(i);
+			size_t offset = (4 + 2*static_cast<size_t>(nzc) + 1 + static_cast<size_t>(nnz)) * sizeof(LIT);
+			size_t align = std::max(alignof(NT), alignof(LIT));
+			return ((offset + align - 1) / align) * align;
+		};
+		int64_t sendbytes = valoffset(locnnz, locnzc) + static_cast<int64_t>(locnnz) * sizeof(NT);
+		char * sendbuf = new char[sendbytes];
+		LIT * header = reinterpret_cast<LIT*>(sendbuf);
+		header[0] = locm;	header[1] = locn;	header[2] = locnnz;	header[3] = locnzc;
+		LIT * jc = header + 4;
+		LIT * cp = jc + locnzc;
+		LIT * ir = cp + locnzc + 1;
+		NT * num = reinterpret_cast<NT*>(sendbuf + valoffset(locnnz, locnzc));
+		LIT k = 0, j = 0;
+		cp[0] = 0;
+		for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)
+		{
+			if(colit.nnz() == 0)	continue;
+			jc[j] = colit.colid();
+			for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
+			{
+				ir[k] = nzit.rowid();
+				num[k++] = nzit.value();
+			}
+			cp[++j] = k;
 		}
-		LIT locm = getlocalcols();
-		LIT locn = getlocalrows();
 		delete spSeq;
 
-		LIT remotem, remoten, remotennz;
-		std::swap(locm,locn);
 		int diagneigh = commGrid->GetComplementRank();
-
-		MPI_Status status;
-		MPI_Sendrecv(&locnnz, 1, MPIType<LIT>(), diagneigh, TRTAGNZ, &remotennz, 1, MPIType<LIT>(), diagneigh, TRTAGNZ, commGrid->GetWorld(), &status);
-		MPI_Sendrecv(&locn, 1, MPIType<LIT>(), diagneigh, TRTAGM, &remotem, 1, MPIType<LIT>(), diagneigh, TRTAGM, commGrid->GetWorld(), &status);
-		MPI_Sendrecv(&locm, 1, MPIType<LIT>(), diagneigh, TRTAGN, &remoten, 1, MPIType<LIT>(), diagneigh, TRTAGN, commGrid->GetWorld(), &status);
-
-		LIT * rowsrecv = new LIT[remotennz];
-		MPI_Sendrecv(rows, locnnz, MPIType<LIT>(), diagneigh, TRTAGROWS, rowsrecv, remotennz, MPIType<LIT>(), diagneigh, TRTAGROWS, commGrid->GetWorld(), &status);
-		delete [] rows;
-
-		LIT * colsrecv = new LIT[remotennz];
-		MPI_Sendrecv(cols, locnnz, MPIType<LIT>(), diagneigh, TRTAGCOLS, colsrecv, remotennz, MPIType<LIT>(), diagneigh, TRTAGCOLS, commGrid->GetWorld(), &status);
-		delete [] cols;
-
-		NT * valsrecv = new NT[remotennz];
-		MPI_Sendrecv(vals, locnnz, MPIType<NT>(), diagneigh, TRTAGVALS, valsrecv, remotennz, MPIType<NT>(), diagneigh, TRTAGVALS, commGrid->GetWorld(), &status);
-		delete [] vals;
+		int64_t recvbytes;
+		MPI_Sendrecv(&sendbytes, 1, MPIType<int64_t>(), diagneigh, TRTAGNZ, &recvbytes, 1, MPIType<int64_t>(), diagneigh, TRTAGNZ, commGrid->GetWorld(), MPI_STATUS_IGNORE);
+		char * recvbuf = new char[recvbytes];
+		SpParHelper::SendrecvBytes(sendbuf, sendbytes, diagneigh, recvbuf, recvbytes, diagneigh, TRTAGVALS, commGrid->GetWorld());
+		delete [] sendbuf;
+
+		// Transpose the received block: entry (i,j) of the remote block becomes (j,i) here
+		header = reinterpret_cast<LIT*>(recvbuf);
+		LIT remotem = header[1];	// rows of the transpose are the remote columns
+		LIT remoten = header[0];
+		LIT remotennz = header[2];
+		LIT remotenzc = header[3];
+		jc = header + 4;
+		cp = jc + remotenzc;
+		ir = cp + remotenzc + 1;
+		num = reinterpret_cast<NT*>(recvbuf + valoffset(remotennz, remotenzc));
 
 		std::tuple<LIT,LIT,NT> * arrtuples = new std::tuple<LIT,LIT,NT>[remotennz];
-		for(LIT i=0; i< remotennz; ++i)
+		if(remoten <= 4 * remotennz)	// counting sort on the new column ids, stable so that rows stay sorted within each column
+		{
+			std::vector<LIT> colstart(remoten+1, 0);
+			for(LIT i=0; i< remotennz; ++i)
+				++colstart[ir[i]+1];
+			std::partial_sum(colstart.begin(), colstart.end(), colstart.begin());
+			for(LIT c=0; c< remotenzc; ++c)
+			{
+				for(LIT i=cp[c]; i< cp[c+1]; ++i)
+				{
+					arrtuples[colstart[ir[i]]++] = std::make_tuple(jc[c], ir[i], num[i]);
+				}
+			}
+		}
+		else	// hypersparse block, a dense counter array would dominate
 		{
-			arrtuples[i] = std::make_tuple(rowsrecv[i], colsrecv[i], valsrecv[i]);
-		}	
-		DeleteAll(rowsrecv, colsrecv, valsrecv);
-		ColLexiCompare<LIT,NT> collexicogcmp;
-		sort(arrtuples , arrtuples+remotennz, collexicogcmp );	// sort w.r.t columns here
+			for(LIT c=0; c< remotenzc; ++c)
+			{
+				for(LIT i=cp[c]; i< cp[c+1]; ++i)
+				{
+					arrtuples[i] = std::make_tuple(jc[c], ir[i], num[i]);
+				}
+			}
+			ColLexiCompare<LIT,NT> collexicogcmp;
+			std::stable_sort(arrtuples, arrtuples+remotennz, collexicogcmp);	// sort w.r.t columns here
+		}
+		delete [] recvbuf;
 
 		spSeq = new DER();
 		spSeq->Create( remotennz, remotem, remoten, arrtuples);		// the deletion of arrtuples[] is handled by SpMat::Create
-	}	
+	}
+	mappedblock.reset();	// both branches leave a block that owns its arrays
 }		
 
 
@@ -3718,8 +4681,9 @@ void SpParMat< IT,NT,DER >::SaveGathered(std::string filename, HANDLER handler,
 
 //! Private subroutine of ReadGeneralizedTuples
 //! totallength is the length of the dictionary, which we don't know in this labeled tuples format apriori
+//! On return, ultimateperm maps every vertex name that appears in this processor's part of the file to its new index
 template <class IT, class NT, class DER>
-MPI_File SpParMat< IT,NT,DER >::TupleRead1stPassNExchange (const std::string & filename, TYPE2SEND * & senddata, IT & totsend, 
+MPI_File SpParMat< IT,NT,DER >::TupleRead1stPassNExchange (const std::string & filename, StringTable & ultimateperm, 
 							FullyDistVec<IT,STRASARRAY> & distmapper, uint64_t & totallength)
 {
     int myrank = commGrid->GetRank();
@@ -3744,21 +4708,23 @@ MPI_File SpParMat< IT,NT,DER >::TupleRead1stPassNExchange (const std::string & f
     MPI_File mpi_fh;
     MPI_File_open (commGrid->commWorld, const_cast<char*>(filename.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &mpi_fh);
 
-    typedef std::map<std::string, uint64_t> KEYMAP; // due to potential (but extremely unlikely) collusions in MurmurHash, make the key to the std:map the string itself
-    std::vector< KEYMAP > allkeys(nprocs);	  // map keeps the outgoing data unique, we could have applied this to HipMer too
-
-    std::vector<std::string> lines;
-    bool finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, true, lines, myrank);
-    int64_t entriesread = lines.size();
-    SpHelper::ProcessLinesWithStringKeys(allkeys, lines,nprocs);
+    // the distinct names read locally, keyed by the name itself (due to potential but extremely unlikely collisions in MurmurHash)
+    // their values are filled with the new indices once the owners have numbered them
+    StringTable & allkeys = ultimateperm;
+    allkeys.Clear();
 
+    std::vector<char> buf;
+    const char * lbeg, * lend;
+    bool finished = false;
+    bool firstcall = true;
+    int64_t entriesread = 0;
     while(!finished)
     {
-        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, false, lines, myrank);
-
-        entriesread += lines.size();
-    	SpHelper::ProcessLinesWithStringKeys(allkeys, lines,nprocs);
+        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, firstcall, buf, lbeg, lend, myrank);
+        firstcall = false;
+        entriesread += SpHelper::ProcessLinesWithStringKeys(allkeys, lbeg, lend);
     }
+    std::vector<char>().swap(buf);
     int64_t allentriesread;
     MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
 #ifdef COMBBLAS_DEBUG
@@ -3766,61 +4732,86 @@ MPI_File SpParMat< IT,NT,DER >::TupleRead1stPassNExchange (const std::string & f
         std::cout << "Initial reading finished. Total number of entries read across all processors is " << allentriesread << std::endl;
 #endif
 
-    int * sendcnt = new int[nprocs];
+    // names travel to the processor that numbers them as (hash, length) pairs plus one blob of packed characters
+    size_t nkeys = allkeys.size();
+    std::vector<int> owners(nkeys);
+    int * sendcnt = new int[nprocs]();
     int * recvcnt = new int[nprocs];
-    for(int i=0; i<nprocs; ++i)
-	sendcnt[i] = allkeys[i].size();
-
+    for(size_t id=0; id<nkeys; ++id)
+    {
+        owners[id] = SpHelper::HashOwner(allkeys.Hash(id), nprocs);
+        ++sendcnt[owners[id]];
+    }
     MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, commGrid->GetWorld()); // share the counts
     int * sdispls = new int[nprocs]();
     int * rdispls = new int[nprocs]();
     std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
     std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
-    totsend = std::accumulate(sendcnt,sendcnt+nprocs, static_cast<IT>(0));
+    IT totsend = std::accumulate(sendcnt,sendcnt+nprocs, static_cast<IT>(0));
     IT totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));	
 
     assert((totsend < std::numeric_limits<int>::max()));	
     assert((totrecv < std::numeric_limits<int>::max()));
 
-    // The following are declared in SpParMat.h
-    // typedef std::array<char, MAXVERTNAME> STRASARRAY;
-    // typedef std::pair< STRASARRAY, uint64_t> TYPE2SEND;
-    senddata = new TYPE2SEND[totsend];	
+    std::vector<size_t> sendorder(totsend);     // entry id of the name at each send position
+    std::vector<int> fill(sdispls, sdispls+nprocs);
+    for(size_t id=0; id<nkeys; ++id)
+        sendorder[fill[owners[id]]++] = id;
+    std::vector<int>().swap(owners);
 
-    #pragma omp parallel for
+    std::vector<uint64_t> sendhash(totsend);
+    std::vector<uint32_t> sendlen(totsend);
+    int * sendbytes = new int[nprocs]();
+    int * recvbytes = new int[nprocs];
     for(int i=0; i<nprocs; ++i)
     {
-	size_t j = 0;
-	for(auto pobj:allkeys[i])
-	{
-		// The naked C-style array type is not copyable or assignable, but pair will require it, hence used std::array
-		std::array<char, MAXVERTNAME> vname;
-		std::copy( pobj.first.begin(), pobj.first.end(), vname.begin() );  
-		if(pobj.first.length() < MAXVERTNAME)  vname[pobj.first.length()] = '\0';	// null termination		
-
-		senddata[sdispls[i]+j] = TYPE2SEND(vname, pobj.second);
-		j++;
-	}
+        int64_t bytes = 0;
+        for(int j=sdispls[i]; j<sdispls[i]+sendcnt[i]; ++j)
+        {
+            sendhash[j] = allkeys.Hash(sendorder[j]);
+            sendlen[j] = allkeys.Length(sendorder[j]);
+            bytes += sendlen[j];
+        }
+        assert((bytes < std::numeric_limits<int>::max()));
+        sendbytes[i] = static_cast<int>(bytes);
     }
-    allkeys.clear();  // allkeys is no longer needed after this point
-
-    MPI_Datatype MPI_HASH;
-    MPI_Type_contiguous(sizeof(TYPE2SEND), MPI_CHAR, &MPI_HASH);
-    MPI_Type_commit(&MPI_HASH);
-
-    TYPE2SEND * recvdata = new TYPE2SEND[totrecv];	
-    MPI_Alltoallv(senddata, sendcnt, sdispls, MPI_HASH, recvdata, recvcnt, rdispls, MPI_HASH, commGrid->GetWorld());
-    // do not delete send buffers yet as we will use them to recv back the data
-    
-    std::set< std::pair<uint64_t, std::string>  > uniqsorted;
+    MPI_Alltoall(sendbytes, 1, MPI_INT, recvbytes, 1, MPI_INT, commGrid->GetWorld());
+    int * sbdispls = new int[nprocs]();
+    int * rbdispls = new int[nprocs]();
+    std::partial_sum(sendbytes, sendbytes+nprocs-1, sbdispls+1);
+    std::partial_sum(recvbytes, recvbytes+nprocs-1, rbdispls+1);
+    int64_t totrecvbytes = std::accumulate(recvbytes, recvbytes+nprocs, static_cast<int64_t>(0));
+    assert((totrecvbytes < std::numeric_limits<int>::max()));
+
+    std::vector<char> sendblob(allkeys.PoolSize());
+    char * blobpos = sendblob.data();
+    for(IT j=0; j<totsend; ++j)
+        blobpos = std::copy(allkeys.Name(sendorder[j]), allkeys.Name(sendorder[j]) + sendlen[j], blobpos);
+
+    std::vector<uint64_t> recvhash(totrecv);
+    std::vector<uint32_t> recvlen(totrecv);
+    std::vector<char> recvblob(totrecvbytes);
+    SpParHelper::Alltoallv(SpHelper::p2a(sendhash), sendcnt, sdispls, MPIType<uint64_t>(), SpHelper::p2a(recvhash), recvcnt, rdispls, MPIType<uint64_t>(), commGrid->GetWorld());
+    SpParHelper::Alltoallv(SpHelper::p2a(sendlen), sendcnt, sdispls, MPIType<uint32_t>(), SpHelper::p2a(recvlen), recvcnt, rdispls, MPIType<uint32_t>(), commGrid->GetWorld());
+    SpParHelper::Alltoallv(SpHelper::p2a(sendblob), sendbytes, sbdispls, MPI_CHAR, SpHelper::p2a(recvblob), recvbytes, rbdispls, MPI_CHAR, commGrid->GetWorld());
+    DeleteAll(sendbytes, recvbytes, sbdispls, rbdispls);
+    std::vector<uint64_t>().swap(sendhash);
+    std::vector<uint32_t>().swap(sendlen);
+    std::vector<char>().swap(sendblob);
+
+    // the same name can arrive from many processors
+    StringTable uniqnames(totrecv);
+    std::vector<size_t> recvid(totrecv);    // entry id in uniqnames of each received name
+    const char * recvpos = recvblob.data();
     for(IT i=0; i< totrecv; ++i)
     {
-	    auto locnull = std::find(recvdata[i].first.begin(), recvdata[i].first.end(), '\0'); // find the null character (or string::end)
-	    std::string strtmp(recvdata[i].first.begin(), locnull); // range constructor 
-	    
-	    uniqsorted.insert(std::make_pair(recvdata[i].second, strtmp));
+        recvid[i] = uniqnames.Insert(recvpos, recvlen[i], recvhash[i], 0);
+        recvpos += recvlen[i];
     }
-    uint64_t uniqsize = uniqsorted.size();
+    std::vector<char>().swap(recvblob);
+    std::vector<uint64_t>().swap(recvhash);
+    std::vector<uint32_t>().swap(recvlen);
+    uint64_t uniqsize = uniqnames.size();
     
 #ifdef COMBBLAS_DEBUG
     if(myrank == 0)
@@ -3833,54 +4824,54 @@ MPI_File SpParMat< IT,NT,DER >::TupleRead1stPassNExchange (const std::string & f
     if(myrank == 0) sizeuntil = 0;  // because MPI_Exscan says the recvbuf in process 0 is undefined
 
     distmapper =  FullyDistVec<IT,STRASARRAY>(commGrid, totallength,STRASARRAY{});	
-	
-    // invindex does not conform to FullyDistVec boundaries, otherwise its contents are essentially the same as distmapper    
-    KEYMAP invindex;	// KEYMAP is map<string, uint64_t>. 
-    uint64_t locindex = 0;
+
+    // number the names in (hash, name) order so that the numbering does not depend on the order they arrived in
+    std::vector<size_t> uniqsorted(uniqsize);
+    std::iota(uniqsorted.begin(), uniqsorted.end(), 0);
+    std::sort(uniqsorted.begin(), uniqsorted.end(), [&uniqnames](size_t a, size_t b)
+    {
+        if(uniqnames.Hash(a) != uniqnames.Hash(b)) return uniqnames.Hash(a) < uniqnames.Hash(b);
+        int cmp = std::memcmp(uniqnames.Name(a), uniqnames.Name(b), std::min(uniqnames.Length(a), uniqnames.Length(b)));
+        return (cmp < 0 || (cmp == 0 && uniqnames.Length(a) < uniqnames.Length(b)));
+    });
+
+    // uniqnames does not conform to FullyDistVec boundaries, otherwise its contents are essentially the same as distmapper    
     std::vector< std::vector< IT > > locs_send(nprocs);
     std::vector< std::vector< std::string > > data_send(nprocs);
     int * map_scnt = new int[nprocs]();	// send counts for this map only (to no confuse with the other sendcnt)        
-    for(auto itr = uniqsorted.begin(); itr != uniqsorted.end(); ++itr)
+    for(uint64_t locindex = 0; locindex < uniqsize; ++locindex)
     {
+	    size_t id = uniqsorted[locindex];
 	    uint64_t globalindex = sizeuntil + locindex;
-	    invindex.insert(std::make_pair(itr->second, globalindex));
+	    uniqnames.Value(id) = globalindex;
 	    
 	    IT newlocid;	
 	    int owner = distmapper.Owner(globalindex, newlocid);
 
-	    //if(myrank == 0)
-	    //    std::cout << "invindex received " << itr->second << " with global index " << globalindex << " to be owned by " << owner << " with index " << newlocid << std::endl;
-
 	    locs_send[owner].push_back(newlocid);
-	    data_send[owner].push_back(itr->second);
+	    // distmapper holds null terminated names of fixed capacity, longer names are truncated there (but not in the matrix)
+	    data_send[owner].push_back(std::string(uniqnames.Name(id), std::min<uint32_t>(uniqnames.Length(id), MAXVERTNAME-1)));
 	    map_scnt[owner]++;
-	    locindex++;
     }
-    uniqsorted.clear();	// clear memory
-
+    std::vector<size_t>().swap(uniqsorted);
 
     /* BEGIN: Redistributing the permutation vector to fit the FullyDistVec semantics */
     SpParHelper::ReDistributeToVector(map_scnt, locs_send, data_send, distmapper.arr, commGrid->GetWorld());   // map_scnt is deleted here
     /* END: Redistributing the permutation vector to fit the FullyDistVec semantics */ 
 
+    // reply with the new index of every received name, in the order they were received
+    std::vector<uint64_t> recvinds(totrecv);
     for(IT i=0; i< totrecv; ++i)
-    {
-	    auto locnull = std::find(recvdata[i].first.begin(), recvdata[i].first.end(), '\0');
-	    std::string searchstr(recvdata[i].first.begin(), locnull); // range constructor 
-
-	    auto resp = invindex.find(searchstr); // recvdata[i] is of type pair< STRASARRAY, uint64_t>
-	    if (resp != invindex.end())
-	    {
-		recvdata[i].second = resp->second;	// now instead of random numbers, recvdata's second entry will be its new index
-	    }
-	    else
-		std::cout << "Assertion failed at proc " << myrank << ": the absence of the entry in invindex is unexpected!!!" << std::endl;
-    }
-    MPI_Alltoallv(recvdata, recvcnt, rdispls, MPI_HASH, senddata, sendcnt, sdispls, MPI_HASH, commGrid->GetWorld());    
-    DeleteAll(recvdata, sendcnt, recvcnt, sdispls, rdispls);
-    MPI_Type_free(&MPI_HASH);
+	    recvinds[i] = uniqnames.Value(recvid[i]);
+    uniqnames.Clear();
+    std::vector<size_t>().swap(recvid);
+
+    std::vector<uint64_t> sendinds(totsend);
+    SpParHelper::Alltoallv(SpHelper::p2a(recvinds), recvcnt, rdispls, MPIType<uint64_t>(), SpHelper::p2a(sendinds), sendcnt, sdispls, MPIType<uint64_t>(), commGrid->GetWorld());
+    DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
+    for(IT j=0; j<totsend; ++j)
+	    allkeys.Value(sendorder[j]) = sendinds[j];
 
-    // the following gets deleted here: allkeys
     return mpi_fh;
 }
 
@@ -3896,28 +4887,11 @@ FullyDistVec<IT,std::array<char, MAXVERTNAME> > SpParMat< IT,NT,DER >::ReadGener
 {       
     int myrank = commGrid->GetRank();
     int nprocs = commGrid->GetSize();  
-    TYPE2SEND * senddata;
-    IT totsend;
     uint64_t totallength;
     FullyDistVec<IT,STRASARRAY> distmapper(commGrid); // choice of array<char, MAXVERTNAME> over string = array is required to be a contiguous container and an aggregate
 
-    MPI_File mpi_fh = TupleRead1stPassNExchange(filename, senddata, totsend, distmapper, totallength);
-
-    typedef std::map<std::string, uint64_t> KEYMAP;    
-    KEYMAP ultimateperm;	// the ultimate permutation
-    for(IT i=0; i< totsend; ++i)	
-    {
-	    auto locnull = std::find(senddata[i].first.begin(), senddata[i].first.end(), '\0');
-	    
-	    std::string searchstr(senddata[i].first.begin(), locnull);
-	    auto ret = ultimateperm.emplace(std::make_pair(searchstr, senddata[i].second));
-	    if(!ret.second)	// the second is the boolean that tells success
-	    {
-	        // remember, we only sent unique vertex ids in the first place so we are expecting unique values in return		
-		std::cout << "the duplication in ultimateperm is unexpected!!!" << std::endl;	
-	    }
-    }
-    delete [] senddata;
+    StringTable ultimateperm;	// the ultimate permutation
+    MPI_File mpi_fh = TupleRead1stPassNExchange(filename, ultimateperm, distmapper, totallength);
 
     // rename the data now, first reset file pointers    
     MPI_Offset fpos, end_fpos;
@@ -3934,21 +4908,29 @@ FullyDistVec<IT,std::array<char, MAXVERTNAME> > SpParMat< IT,NT,DER >::ReadGener
     else end_fpos = file_size;
 
     typedef typename DER::LocalIT LIT;
-    std::vector<LIT> rows;
-    std::vector<LIT> cols;
+    std::vector<IT> rows;   // global indices, converted to local ones when they are sent to their owners
+    std::vector<IT> cols;
     std::vector<NT> vals;
 
-    std::vector<std::string> lines;
-    bool finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, true, lines, myrank);
-    int64_t entriesread = lines.size();
-   
-    SpHelper::ProcessStrLinesNPermute(rows, cols, vals, lines, ultimateperm);
-
-    while(!finished)
+    // streamed as in ParallelReadMM: every batch of lines is sent to its owners before the next one is read
+    std::vector<char> buf;
+    const char * lbeg, * lend;
+    bool finished = false;
+    bool firstcall = true;
+    int alldone = 0;
+    int64_t entriesread = 0;
+    std::vector< std::vector< std::tuple<LIT,LIT,NT> > > received;
+    while(!alldone)
     {
-        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, false, lines, myrank);
-        entriesread += lines.size();
-    	SpHelper::ProcessStrLinesNPermute(rows, cols, vals, lines, ultimateperm);
+        if(!finished)
+        {
+            finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, firstcall, buf, lbeg, lend, myrank);
+            firstcall = false;
+            entriesread += SpHelper::ProcessStrLinesNPermute(rows, cols, vals, lbeg, lend, ultimateperm);
+        }
+        ExchangeTuplesChunk(rows, cols, vals, static_cast<IT>(totallength), static_cast<IT>(totallength), received);
+        int done = finished;
+        MPI_Allreduce(&done, &alldone, 1, MPI_INT, MPI_LAND, commGrid->GetWorld());
     }
     int64_t allentriesread;
     MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
@@ -3958,26 +4940,10 @@ FullyDistVec<IT,std::array<char, MAXVERTNAME> > SpParMat< IT,NT,DER >::ReadGener
 #endif
 
     MPI_File_close(&mpi_fh);
-    std::vector< std::vector < std::tuple<LIT,LIT,NT> > > data(nprocs);
-    
-    LIT locsize = rows.size();   // remember: locsize != entriesread (unless the matrix is unsymmetric)
-    for(LIT i=0; i<locsize; ++i)
-    {
-        LIT lrow, lcol;
-        int owner = Owner(totallength, totallength, rows[i], cols[i], lrow, lcol);
-        data[owner].push_back(std::make_tuple(lrow,lcol,vals[i]));
-    }
-    std::vector<LIT>().swap(rows);
-    std::vector<LIT>().swap(cols);
-    std::vector<NT>().swap(vals);	
-
-#ifdef COMBBLAS_DEBUG
-    if(myrank == 0)
-        std::cout << "Packing to recipients finished, about to send..." << std::endl;
-#endif
-    
+    std::vector<char>().swap(buf);
+    ultimateperm.Clear();
     if(spSeq)   delete spSeq;
-    SparseCommon(data, locsize, totallength, totallength, BinOp);
+    SparseFromTupleChunks(received, static_cast<IT>(totallength), static_cast<IT>(totallength), BinOp);
     // PrintInfo();
     // distmapper.ParallelWrite("distmapper.mtx", 1, CharArraySaveHandler());
     return distmapper; 
@@ -4082,22 +5048,38 @@ void SpParMat< IT,NT,DER >::ParallelReadMM (const std::string & filename, bool o
 
 	 
     typedef typename DER::LocalIT LIT;
-    std::vector<LIT> rows;
-    std::vector<LIT> cols;
+    std::vector<IT> rows;   // global indices, converted to local ones when they are sent to their owners
+    std::vector<IT> cols;
     std::vector<NT> vals;
 
-    std::vector<std::string> lines;
-    bool finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, true, lines, myrank);
-    int64_t entriesread = lines.size();
-    SpHelper::ProcessLines(rows, cols, vals, lines, symmetric, type, onebased);
-    MPI_Barrier(commGrid->commWorld);
-
-    while(!finished)
+    // lines are tokenized in place in the MPI-IO buffer (multithreaded if THREADED), no per-line strings are created
+    // the file is streamed: every parsed chunk is sent to its owners right away, so only the received entries (about
+    // the size of the final local matrix) accumulate, instead of all parsed entries plus their packed copies
+    std::vector<char> buf;
+    const char * lbeg;
+    const char * lend;
+    bool finished = false;
+    bool firstcall = true;
+    int alldone = 0;
+    int64_t entriesread = 0;
+    std::vector< std::vector< std::tuple<LIT,LIT,NT> > > received;
+    while(!alldone)
     {
-        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, false, lines, myrank);
-        entriesread += lines.size();
-        SpHelper::ProcessLines(rows, cols, vals, lines, symmetric, type, onebased);
+        if(!finished)
+        {
+            finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, firstcall, buf, lbeg, lend, myrank);
+            firstcall = false;
+            entriesread += SpHelper::ProcessLines(rows, cols, vals, lbeg, lend, symmetric, type, onebased);
+        }
+        ExchangeTuplesChunk(rows, cols, vals, nrows, ncols, received);
+        int done = finished;
+        MPI_Allreduce(&done, &alldone, 1, MPI_INT, MPI_LAND, commGrid->GetWorld());
     }
+    std::vector<char>().swap(buf);
+    std::vector<IT>().swap(rows);
+    std::vector<IT>().swap(cols);
+    std::vector<NT>().swap(vals);
+    MPI_File_close(&mpi_fh);
     int64_t allentriesread;
     MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
 #ifdef COMBBLAS_DEBUG
@@ -4105,26 +5087,8 @@ void SpParMat< IT,NT,DER >::ParallelReadMM (const std::string & filename, bool o
         std::cout << "Reading finished. Total number of entries read across all processors is " << allentriesread << std::endl;
 #endif
 
-    std::vector< std::vector < std::tuple<LIT,LIT,NT> > > data(nprocs);
-    
-    LIT locsize = rows.size();   // remember: locsize != entriesread (unless the matrix is unsymmetric)
-    for(LIT i=0; i<locsize; ++i)
-    {
-        LIT lrow, lcol;
-        int owner = Owner(nrows, ncols, rows[i], cols[i], lrow, lcol);
-        data[owner].push_back(std::make_tuple(lrow,lcol,vals[i]));
-    }
-    std::vector<LIT>().swap(rows);
-    std::vector<LIT>().swap(cols);
-    std::vector<NT>().swap(vals);	
-
-#ifdef COMBBLAS_DEBUG
-    if(myrank == 0)
-        std::cout << "Packing to recepients finished, about to send..." << std::endl;
-#endif
-    
     if(spSeq)   delete spSeq;
-    SparseCommon(data, locsize, nrows, ncols, BinOp);
+    SparseFromTupleChunks(received, nrows, ncols, BinOp);
 }
 
 
@@ -4215,6 +5179,208 @@ void SpParMat< IT,NT,DER >::ParallelWriteMM(const std::string & filename, bool o
 }
 
 
+/**
+ * Writes the matrix as text, one "row col value" line per nonzero, without going through iostreams
+ * Each rank formats its local submatrix into a byte buffer (in parallel with THREADED), ranks find their file offsets with
+ * MPI_Exscan and the whole file is written with a single collective call
+ * @param[in] header {start with a Matrix Market banner and size line; without it the output is a plain edge list}
+ * @param[in] compresslevel {0 writes plain text, 1-9 writes gzip at that level with every thread's piece compressed as an
+ * independent gzip member (requires zlib, i.e. COMBBLAS_ZLIB); the concatenated members are read by any gzip decoder}
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ParallelWriteMM(const std::string & filename, bool onebased, bool header, int compresslevel)
+{
+    int myrank = commGrid->GetRank();
+    if constexpr (!std::is_arithmetic<NT>::value)
+    {
+        if(myrank == 0 && (!header || compresslevel > 0))
+            std::cout << "COMBBLAS: only arithmetic types can be written as edge lists or compressed, writing a Matrix Market file instead" << std::endl;
+        ParallelWriteMM(filename, onebased, ScalarReadSaveHandler());
+        return;
+    }
+    else
+    {
+#ifndef COMBBLAS_ZLIB
+        if(compresslevel > 0)
+        {
+            if(myrank == 0)
+                std::cout << "COMBBLAS: compiled without zlib, writing uncompressed text" << std::endl;
+            compresslevel = 0;
+        }
+#endif
+        IT totalm = getnrow();
+        IT totaln = getncol();
+        IT totnnz = getnnz();
+        IT roffset = 0;
+        IT coffset = 0;
+        GetPlaceInGlobalGrid(roffset, coffset);
+        if(onebased)
+        {
+            roffset += 1;    // increment by 1
+            coffset += 1;
+        }
+
+        std::string banner;
+        if(myrank == 0 && header)
+        {
+            std::stringstream ss;
+            ss << "%%MatrixMarket matrix coordinate " << (std::is_integral<NT>::value ? "integer" : "real") << " general" << std::endl;
+            ss << totalm << " " << totaln << " " << totnnz << std::endl;
+            banner = ss.str();
+        }
+
+        const size_t linebound = 3*SpHelper::MAXNUMBERCHARS + 3;
+        ParallelWriteText(filename, banner, compresslevel, linebound, [roffset, coffset](char * p, IT lrow, IT lcol, const NT & val)
+        {
+            p = SpHelper::FormatNumber(p, lrow + roffset);
+            *p++ = '\t';
+            p = SpHelper::FormatNumber(p, lcol + coffset);
+            *p++ = '\t';
+            p = SpHelper::FormatNumber(p, val);
+            *p++ = '\n';
+            return p;
+        });
+    }
+}
+
+/**
+ * Writes the matrix as a labeled edge list, one "rowname colname value" line per nonzero, that ReadGeneralizedTuples
+ * reads back; distmapper holds the vertex names (as returned by ReadGeneralizedTuples). Each rank fetches the names of
+ * its block's rows and columns once with FullyDistVec::GetRange and formats its lines in parallel
+ */
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::ParallelWriteGeneralizedTuples(const std::string & filename, const FullyDistVec<IT,std::array<char, MAXVERTNAME>> & distmapper, int compresslevel)
+{
+    static_assert(std::is_arithmetic<NT>::value, "labeled edge lists are written for numerical types only");
+#ifndef COMBBLAS_ZLIB
+    if(compresslevel > 0)
+    {
+        if(commGrid->GetRank() == 0)
+            std::cout << "COMBBLAS: compiled without zlib, writing uncompressed text" << std::endl;
+        compresslevel = 0;
+    }
+#endif
+    IT roffset = 0;
+    IT coffset = 0;
+    GetPlaceInGlobalGrid(roffset, coffset);
+    std::vector< std::array<char, MAXVERTNAME> > rownames, colnames;
+    distmapper.GetRange(roffset, roffset + getlocalrows(), rownames);
+    distmapper.GetRange(coffset, coffset + getlocalcols(), colnames);
+
+    const size_t linebound = 2*MAXVERTNAME + SpHelper::MAXNUMBERCHARS + 3;
+    ParallelWriteText(filename, std::string(), compresslevel, linebound, [&rownames, &colnames](char * p, IT lrow, IT lcol, const NT & val)
+    {
+        const char * name = rownames[lrow].data();
+        size_t len = strnlen(name, MAXVERTNAME);
+        std::memcpy(p, name, len);
+        p += len;
+        *p++ = '\t';
+        name = colnames[lcol].data();
+        len = strnlen(name, MAXVERTNAME);
+        std::memcpy(p, name, len);
+        p += len;
+        *p++ = '\t';
+        p = SpHelper::FormatNumber(p, val);
+        *p++ = '\n';
+        return p;
+    });
+}
+
+/**
+ * Text output engine of ParallelWriteMM and ParallelWriteGeneralizedTuples
+ * Nonempty local columns are split among threads so that each thread formats about the same number of nonzeros,
+ * formatentry(p, localrow, localcol, value) writes one line at p (at most linebound bytes) and returns the position
+ * after it. Ranks find their file offsets with MPI_Exscan and the whole file is written with a single collective call
+ */
+template <class IT, class NT, class DER>
+template <typename _FormatEntry>
+void SpParMat< IT,NT,DER >::ParallelWriteText(const std::string & filename, std::string banner, int compresslevel, size_t linebound, _FormatEntry formatentry)
+{
+    int myrank = commGrid->GetRank();
+    std::vector<typename DER::SpColIter> colits;
+    for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)
+        colits.push_back(colit);
+    int64_t localnnz = getlocalnnz();
+    int nthreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+    {
+        nthreads = omp_get_num_threads();
+    }
+#endif
+    std::vector<size_t> colsplit(nthreads+1, colits.size());
+    colsplit[0] = 0;
+    for(int t=1; t<nthreads; ++t)
+    {
+        int64_t target = localnnz * t / nthreads;
+        colsplit[t] = std::lower_bound(colits.begin(), colits.end(), target, [](const typename DER::SpColIter & colit, int64_t val)
+                                       { return static_cast<int64_t>(colit.colptr()) < val; }) - colits.begin();
+    }
+
+    std::vector< std::vector<char> > pieces(nthreads);
+#ifdef THREADED
+#pragma omp parallel for schedule(static, 1) num_threads(nthreads)
+#endif
+    for(int t=0; t<nthreads; ++t)
+    {
+        std::vector<char> & text = pieces[t];
+        size_t pos = 0;
+        for(size_t k=colsplit[t]; k<colsplit[t+1]; ++k)
+        {
+            typename DER::SpColIter colit = colits[k];
+            if(text.size() - pos < colit.nnz() * linebound)
+                text.resize(std::max(2*text.size(), pos + colit.nnz() * linebound));
+            for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
+            {
+                char * p = formatentry(text.data() + pos, nzit.rowid(), colit.colid(), nzit.value());
+                pos = p - text.data();
+            }
+        }
+        text.resize(pos);
+#ifdef COMBBLAS_ZLIB
+        if(compresslevel > 0 && pos > 0)
+        {
+            std::vector<char> compressed;
+            SpHelper::GzipCompress(text.data(), text.size(), compresslevel, compressed);
+            text.swap(compressed);
+        }
+#endif
+    }
+    std::vector<typename DER::SpColIter>().swap(colits);
+#ifdef COMBBLAS_ZLIB
+    if(compresslevel > 0 && !banner.empty())
+    {
+        std::vector<char> compressed;
+        SpHelper::GzipCompress(banner.data(), banner.size(), compresslevel, compressed);
+        banner.assign(compressed.begin(), compressed.end());
+    }
+#endif
+
+    std::vector<const void *> addrs = {banner.data()};
+    std::vector<int64_t> bytes = {static_cast<int64_t>(banner.size())};
+    for(int t=0; t<nthreads; ++t)
+    {
+        addrs.push_back(pieces[t].data());
+        bytes.push_back(pieces[t].size());
+    }
+    int64_t localbytes = std::accumulate(bytes.begin(), bytes.end(), static_cast<int64_t>(0));
+    int64_t bytesuntil = 0, bytestotal = 0;
+    MPI_Exscan(&localbytes, &bytesuntil, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+    if(myrank == 0) bytesuntil = 0;    // because MPI_Exscan says the recvbuf in process 0 is undefined
+    MPI_Allreduce(&localbytes, &bytestotal, 1, MPIType<int64_t>(), MPI_SUM, commGrid->GetWorld());
+
+    MPI_File thefile;
+    MPI_File_open(commGrid->GetWorld(), (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile);
+    MPI_File_set_size(thefile, bytestotal);    // truncate any previous (larger) file
+    MPI_Datatype memtype;
+    SpParHelper::MemoryRegionsType(addrs, bytes, memtype);
+    MPI_Status status;
+    MPI_File_write_at_all(thefile, bytesuntil, MPI_BOTTOM, 1, memtype, &status);
+    MPI_Type_free(&memtype);
+    MPI_File_close(&thefile);
+}
+
+
 
 //! Handles all sorts of orderings as long as there are no duplicates
 //! May perform better when the data is already reverse column-sorted (i.e. in decreasing order)
@@ -4223,6 +5389,7 @@ template <class IT, class NT, class DER>
 template <class HANDLER>
 void SpParMat< IT,NT,DER >::ReadDistribute (const std::string & filename, int master, bool nonum, HANDLER handler, bool transpose, bool pario)
 {
+	++version;
 #ifdef TAU_PROFILE
    	TAU_PROFILE_TIMER(rdtimer, "ReadDistribute", "void SpParMat::ReadDistribute (const string & , int, bool, HANDLER, bool)", TAU_DEFAULT);
    	TAU_PROFILE_START(rdtimer);
@@ -4232,9 +5399,21 @@ void SpParMat< IT,NT,DER >::ReadDistribute (const std::string & filename, int ma
 	FILE * binfile = NULL;	// points to "past header" if the file is binary
 	int seeklength = 0;
 	HeaderInfo hfile;
+	int compressed = 0;
 	if(commGrid->GetRank() == master)	// 1 processor
 	{
 		hfile = ParseHeader(filename, binfile, seeklength);
+		if(hfile.headerexists && hfile.format == 2)
+		{
+			compressed = 1;
+			fclose(binfile);
+		}
+	}
+	MPI_Bcast(&compressed, 1, MPI_INT, master, commGrid->commWorld);
+	if(compressed)	// compressed edge files are always read in parallel (one of any duplicate entries is kept)
+	{
+		ParallelCompressedRead(filename, [](const NT & a, const NT &) { return a; }, transpose);
+		return;
 	}
 	MPI_Bcast(&seeklength, 1, MPI_INT, master, commGrid->commWorld);
 
@@ -4551,6 +5730,7 @@ void SpParMat< IT,NT,DER >::ReadDistribute (const std::string & filename, int ma
  	IT localm = (commGrid->myprocrow != (commGrid->grrows-1))? m_perproc: (total_m - (m_perproc * (commGrid->grrows-1)));
  	IT localn = (commGrid->myproccol != (commGrid->grcols-1))? n_perproc: (total_n - (n_perproc * (commGrid->grcols-1)));
 	spSeq->Create( localtuples.size(), localm, localn, arrtuples);		// the deletion of arrtuples[] is handled by SpMat::Create
+	mappedblock.reset();
 
 #ifdef TAU_PROFILE
    	TAU_PROFILE_STOP(rdtimer);
@@ -4603,9 +5783,9 @@ void SpParMat<IT,NT,DER>::VerticalSend(IT * & rows, IT * & cols, NT * & vals, st
 	NT * tempvals = new NT[totrecv];
 	
 	// then, exchange all buffers that to their recipients ...
-	MPI_Alltoallv(rows, ccurptrs, cdispls, MPIType<IT>(), temprows, colrecvcounts, colrecvdispls, MPIType<IT>(), commGrid->colWorld);
-	MPI_Alltoallv(cols, ccurptrs, cdispls, MPIType<IT>(), tempcols, colrecvcounts, colrecvdispls, MPIType<IT>(), commGrid->colWorld);
-	MPI_Alltoallv(vals, ccurptrs, cdispls, MPIType<NT>(), tempvals, colrecvcounts, colrecvdispls, MPIType<NT>(), commGrid->colWorld);
+	SpParHelper::Alltoallv(rows, ccurptrs, cdispls, MPIType<IT>(), temprows, colrecvcounts, colrecvdispls, MPIType<IT>(), commGrid->colWorld);
+	SpParHelper::Alltoallv(cols, ccurptrs, cdispls, MPIType<IT>(), tempcols, colrecvcounts, colrecvdispls, MPIType<IT>(), commGrid->colWorld);
+	SpParHelper::Alltoallv(vals, ccurptrs, cdispls, MPIType<NT>(), tempvals, colrecvcounts, colrecvdispls, MPIType<NT>(), commGrid->colWorld);
 
 	// finally, reset current pointers !
 	std::fill_n(ccurptrs, colneighs, 0);
@@ -4834,9 +6014,9 @@ void SpParMat<IT,NT,DER>::Find (FullyDistVec<IT,IT> & distrows, FullyDistVec<IT,
 	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdpls+1);
 	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdpls+1);
 
-	MPI_Alltoallv(rows, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(nrows.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
-	MPI_Alltoallv(cols, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(ncols.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
-	MPI_Alltoallv(vals, sendcnt, sdpls, MPIType<NT>(), SpHelper::p2a(nvals.arr), recvcnt, rdpls, MPIType<NT>(), commGrid->GetWorld());
+	SpParHelper::Alltoallv(rows, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(nrows.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
+	SpParHelper::Alltoallv(cols, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(ncols.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
+	SpParHelper::Alltoallv(vals, sendcnt, sdpls, MPIType<NT>(), SpHelper::p2a(nvals.arr), recvcnt, rdpls, MPIType<NT>(), commGrid->GetWorld());
 
 	DeleteAll(sendcnt, recvcnt, sdpls, rdpls);
 	DeleteAll(prelens, rows, cols, vals);
@@ -4908,8 +6088,8 @@ void SpParMat<IT,NT,DER>::Find (FullyDistVec<IT,IT> & distrows, FullyDistVec<IT,
 	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdpls+1);
 	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdpls+1);
 
-	MPI_Alltoallv(rows, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(nrows.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
-	MPI_Alltoallv(cols, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(ncols.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
+	SpParHelper::Alltoallv(rows, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(nrows.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
+	SpParHelper::Alltoallv(cols, sendcnt, sdpls, MPIType<IT>(), SpHelper::p2a(ncols.arr), recvcnt, rdpls, MPIType<IT>(), commGrid->GetWorld());
 
 	DeleteAll(sendcnt, recvcnt, sdpls, rdpls);
 	DeleteAll(prelens, rows, cols, vals);
@@ -5022,7 +6202,7 @@ DER SpParMat<IT,NT,DER>::InducedSubgraphs2Procs(const FullyDistVec<IT,IT>& Assig
         std::copy(svec[i].begin(), svec[i].end(), sbuf + sdispls[i]);
 
 
-    MPI_Alltoallv(sbuf, sendcounts.data(), sdispls.data(), MPIType<std::tuple<IT,IT,NT>>(), rbuf, recvcounts.data(), rdispls.data(), MPIType<std::tuple<IT,IT,NT>>(), World);
+    SpParHelper::Alltoallv(sbuf, sendcounts.data(), sdispls.data(), MPIType<std::tuple<IT,IT,NT>>(), rbuf, recvcounts.data(), rdispls.data(), MPIType<std::tuple<IT,IT,NT>>(), World);
 
     delete[] sbuf;
 
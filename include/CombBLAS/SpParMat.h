@@ -99,6 +99,13 @@ public:
 	float LoadImbalance() const;
 	void Transpose();
 	void FreeMemory();
+
+	// Opt-in cached views, rebuilt only when the matrix changed since they were made (see version)
+	const SpParMat< IT,NT,DER > & TransposeView() const;	//!< distributed transpose
+	const DER & LocalRowView() const;	//!< transpose of the local block: its rows are the columns of this DER (CSR access)
+	void ReleaseViews() const;
+	uint64_t getversion() const { return version; }
+	void Touch() { ++version; }	//!< call after changing the local matrix through seq() or seqptr()
 	void EWiseMult (const SpParMat< IT,NT,DER >  & rhs, bool exclude);
 	void SetDifference (const SpParMat< IT,NT,DER >  & rhs);
 	void EWiseScale (const DenseParMat<IT,NT> & rhs);
@@ -147,6 +154,7 @@ public:
 	template <typename _UnaryOperation>
 	void Apply(_UnaryOperation __unary_op)
 	{
+		++version;
 		spSeq->Apply(__unary_op);	
 	}
 
@@ -165,6 +173,7 @@ public:
 		GetPlaceInGlobalGrid(grow, gcol);
 		if (inPlace)
 		{
+			++version;
 			spSeq->PruneI(__unary_op, inPlace, grow, gcol);
 			return SpParMat<IT,NT,DER>(getcommgrid()); // return blank to match signature
 		}
@@ -179,6 +188,7 @@ public:
 	{
 		if (inPlace)
 		{
+			++version;
 			spSeq->Prune(__unary_op, inPlace);
 			return SpParMat<IT,NT,DER>(getcommgrid()); // return blank to match signature
 		}
@@ -279,13 +289,24 @@ public:
     
     template <class HANDLER>
     void ParallelWriteMM(const std::string & filename, bool onebased, HANDLER handler);
-    void ParallelWriteMM(const std::string & filename, bool onebased) { ParallelWriteMM(filename, onebased, ScalarReadSaveHandler()); };
+    void ParallelWriteMM(const std::string & filename, bool onebased, bool header = true, int compresslevel = 0);
 
     void ParallelBinaryWrite(std::string filename) const;
+    template <typename _BinaryOperation>
+    void ParallelBinaryRead(const std::string & filename, _BinaryOperation BinOp);
+    void ParallelBlockWrite(const std::string & filename) const;
+    void ParallelBlockRead(const std::string & filename);
+    void ParallelBlockMap(const std::string & filename);
+    void ParallelCompressedWrite(const std::string & filename, bool withvalues = true, IT blocknnz = ONEMILLION) const;
+    template <typename _BinaryOperation>
+    void ParallelCompressedRead(const std::string & filename, _BinaryOperation BinOp, bool transpose = false);
     
     template <typename _BinaryOperation>
     FullyDistVec<IT,std::array<char, MAXVERTNAME>> ReadGeneralizedTuples(const std::string&, _BinaryOperation);
-    
+    void ParallelWriteGeneralizedTuples(const std::string & filename, const FullyDistVec<IT,std::array<char, MAXVERTNAME>> & distmapper, int compresslevel = 0);
+
+    void GenerateRMAT(int scale, int edgefactor, const double initiator[4], uint64_t seed = 1, bool removeloops = true);
+
 	template <class HANDLER>
 	void ReadDistribute (const std::string & filename, int master, bool nonum, HANDLER handler, bool transpose = false, bool pario = false);
 	void ReadDistribute (const std::string & filename, int master, bool nonum=false, bool pario = false) 
@@ -309,6 +330,12 @@ public:
     template <typename _BinaryOperation, typename LIT>
     void SparseCommon(std::vector< std::vector < std::tuple<LIT,LIT,NT> > > & data, LIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp);
     //void SparseCommon(std::vector< std::vector < std::tuple<typename DER::LocalIT,typename DER::LocalIT,NT> > > & data, typename DER::LocalIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp);
+    template <typename _BinaryOperation, typename LIT>
+    void SparseFromTuples(std::tuple<LIT,LIT,NT> * localtuples, LIT ntuples, IT total_m, IT total_n, _BinaryOperation BinOp);
+    template <typename _BinaryOperation, typename LIT>
+    void SparseFromTupleChunks(std::vector< std::vector< std::tuple<LIT,LIT,NT> > > & chunks, IT total_m, IT total_n, _BinaryOperation BinOp);
+    template <typename LIT>
+    void ExchangeTuplesChunk(std::vector<IT> & rows, std::vector<IT> & cols, std::vector<NT> & vals, IT total_m, IT total_n, std::vector< std::vector< std::tuple<LIT,LIT,NT> > > & chunks);
 
 	// @TODO-OGUZ allow different index type for blocked matrices
 	std::vector<std::vector<SpParMat<IT, NT, DER>>>
@@ -326,11 +353,19 @@ public:
 
 	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend SpParMat<IU,NUO,UDERO> 
-	Mult_AnXBn_Synch (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
+	Mult_AnXBn_Synch (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB, bool incrementalMerge);
 
 	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend SpParMat<IU,NUO,UDERO> 
 	Mult_AnXBn_Overlap (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
+
+	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
+	friend SpParMat<IU,NUO,UDERO> 
+	Mult_AnXBn_Pipelined (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB, bool incrementalMerge);
+
+	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename NUM, typename UDER1, typename UDER2, typename UDERM>
+	friend SpParMat<IU,NUO,UDERO>
+	Mult_AnXBn_Masked (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, const SpParMat<IU,NUM,UDERM> & M, bool complement, bool clearA, bool clearB);
     
     template <typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
     friend int64_t EstPerProcessNnzSUMMA(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool hashEstimate);
@@ -353,7 +388,7 @@ public:
 
     template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
     friend SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
-                                               int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int computationKernel, int64_t perProcessMem);
+                                               int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int computationKernel, int64_t perProcessMem, bool fusePruneSelect);
 
     template <typename SR, typename ITA, typename NTA, typename DERA>
     friend SpParMat<ITA, NTA, DERA> IncrementalMCLSquare (SpParMat<ITA, NTA, DERA> & A,
@@ -403,7 +438,6 @@ public:
 
 private:
 	typedef std::array<char, MAXVERTNAME> STRASARRAY;
-	typedef std::pair< STRASARRAY, uint64_t> TYPE2SEND;
 
 	class CharArraySaveHandler
 	{
@@ -418,7 +452,9 @@ private:
     		}
 	};
     
-	MPI_File TupleRead1stPassNExchange (const std::string & filename, TYPE2SEND * & senddata, IT & totsend, FullyDistVec<IT,STRASARRAY> & distmapper, uint64_t & totallength);
+	MPI_File TupleRead1stPassNExchange (const std::string & filename, StringTable & ultimateperm, FullyDistVec<IT,STRASARRAY> & distmapper, uint64_t & totallength);
+	template <typename _FormatEntry>
+	void ParallelWriteText(const std::string & filename, std::string banner, int compresslevel, size_t linebound, _FormatEntry formatentry);
 
 	template <typename VT, typename GIT, typename _BinaryOperation, typename _UnaryOperation >
     	void Reduce(FullyDistVec<GIT,VT> & rvec, Dim dim, _BinaryOperation __binary_op, VT id, _UnaryOperation __unary_op, MPI_Op mympiop) const;
@@ -447,6 +483,13 @@ private:
 	
 	std::shared_ptr<CommGrid> commGrid; 
 	DER * spSeq;
+	std::shared_ptr<char> mappedblock;	//!< file mapping that spSeq's arrays may point into (see ParallelBlockMap)
+
+	uint64_t version = 0;	//!< bumped by every method that changes the matrix
+	mutable std::shared_ptr< SpParMat< IT,NT,DER > > transposeview;
+	mutable uint64_t transposeversion = 0;	//!< version of the matrix that transposeview was made from
+	mutable std::shared_ptr<DER> rowview;
+	mutable uint64_t rowversion = 0;
 	
 	template <class IU, class NU>
 	friend class DenseParMat;
@@ -86,7 +86,7 @@ namespace combblas
 
         std::tuple<IT,IT,NT>* recvTuples = new std::tuple<IT,IT,NT>[totrecv];
         //std::vector< std::tuple<IT,IT,NT> > recvTuples(totrecv);
-        MPI_Alltoallv(sendTuples.data(), sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, World);
+        SpParHelper::Alltoallv(sendTuples.data(), sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, World);
         DeleteAll(sendcnt, recvcnt, sdispls, rdispls); // free all memory
         MPI_Type_free(&MPI_tuple);
         datasize = totrecv;
@@ -141,7 +141,7 @@ namespace combblas
             }
         }
 
-        MPI_Alltoallv(sendTuples, sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, World);
+        SpParHelper::Alltoallv(sendTuples, sendcnt, sdispls, MPI_tuple, recvTuples, recvcnt, rdispls, MPI_tuple, World);
 	    DeleteAll(sendcnt, sendprfl, sdispls, sendTuples);
 
         //tuple<LIT, LIT, NT> ** tempTuples = new tuple<LIT, LIT, NT>*[numChunks];
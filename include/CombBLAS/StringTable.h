@@ -0,0 +1,166 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef _STRING_TABLE_H_
+#define _STRING_TABLE_H_
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+namespace combblas {
+
+/**
+ * Open addressing (linear probing) hash table from strings to uint64_t values
+ * The characters of all keys are packed back to back into a single arena, so a key costs its length plus a 32-byte entry
+ * and a 8-byte slot, instead of a std::string and a tree node. The hash of a key is supplied by the caller (vertex names
+ * are already MurmurHash'ed to find their owners) and is stored with the entry so that neither probing nor growing
+ * ever rehashes the characters. Entries are numbered 0,1,2,... in insertion order and are never removed
+ */
+class StringTable
+{
+public:
+	StringTable(size_t expected = 0): mask(0)
+	{
+		Reserve(expected);
+	}
+
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+
+	//! Makes room for n keys without growing the slot array
+	void Reserve(size_t n)
+	{
+		size_t capacity = 16;
+		while(capacity < 2*n) capacity <<= 1;	// keep the load factor at or below 1/2
+		if(capacity > slots.size()) Rehash(capacity);
+		entries.reserve(n);
+	}
+
+	/**
+	 * Inserts (name[0..len), value) unless name is already present
+	 * @return the id of the (existing or new) entry, inserted tells which one it is
+	 */
+	size_t Insert(const char * name, uint32_t len, uint64_t hash, uint64_t value, bool & inserted)
+	{
+		if(2*(entries.size()+1) > slots.size()) Rehash(slots.empty() ? 16 : 2*slots.size());
+		size_t pos = hash & mask;
+		while(slots[pos] != 0)
+		{
+			size_t id = slots[pos]-1;
+			if(Matches(id, name, len, hash))
+			{
+				inserted = false;
+				return id;
+			}
+			pos = (pos + 1) & mask;
+		}
+		Entry entry = {hash, static_cast<uint64_t>(pool.size()), value, len};
+		pool.insert(pool.end(), name, name+len);
+		entries.push_back(entry);
+		slots[pos] = entries.size();
+		inserted = true;
+		return entries.size()-1;
+	}
+
+	size_t Insert(const char * name, uint32_t len, uint64_t hash, uint64_t value)
+	{
+		bool inserted;
+		return Insert(name, len, hash, value, inserted);
+	}
+
+	//! @return a pointer to the value of name, or NULL if it is absent
+	const uint64_t * Find(const char * name, uint32_t len, uint64_t hash) const
+	{
+		if(slots.empty()) return NULL;
+		size_t pos = hash & mask;
+		while(slots[pos] != 0)
+		{
+			size_t id = slots[pos]-1;
+			if(Matches(id, name, len, hash))
+				return &(entries[id].value);
+			pos = (pos + 1) & mask;
+		}
+		return NULL;
+	}
+
+	// accessors by entry id; Name() is invalidated by the next Insert
+	const char * Name(size_t id) const { return pool.data() + entries[id].offset; }
+	uint32_t Length(size_t id) const { return entries[id].len; }
+	uint64_t Hash(size_t id) const { return entries[id].hash; }
+	uint64_t & Value(size_t id) { return entries[id].value; }
+	uint64_t Value(size_t id) const { return entries[id].value; }
+
+	//! Total number of characters in all keys
+	size_t PoolSize() const { return pool.size(); }
+
+	void Clear()
+	{
+		std::vector<char>().swap(pool);
+		std::vector<Entry>().swap(entries);
+		std::vector<uint64_t>().swap(slots);
+		mask = 0;
+	}
+
+private:
+	struct Entry
+	{
+		uint64_t hash;
+		uint64_t offset;	// into pool
+		uint64_t value;
+		uint32_t len;
+	};
+
+	bool Matches(size_t id, const char * name, uint32_t len, uint64_t hash) const
+	{
+		const Entry & entry = entries[id];
+		return (entry.hash == hash && entry.len == len && std::memcmp(pool.data() + entry.offset, name, len) == 0);
+	}
+
+	void Rehash(size_t capacity)
+	{
+		std::vector<uint64_t>(capacity, 0).swap(slots);	// 0 is empty, otherwise entry id + 1
+		mask = capacity-1;
+		for(size_t id = 0; id < entries.size(); ++id)
+		{
+			size_t pos = entries[id].hash & mask;
+			while(slots[pos] != 0) pos = (pos + 1) & mask;
+			slots[pos] = id+1;
+		}
+	}
+
+	std::vector<char> pool;
+	std::vector<Entry> entries;
+	std::vector<uint64_t> slots;
+	size_t mask;
+};
+
+}
+
+#endif
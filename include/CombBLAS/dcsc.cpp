@@ -196,7 +196,7 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::AddAndAssign (StackEntry<NT, std::pair<IT,IT> > * mul
   */
 template <class IT, class NT>
 Dcsc<IT,NT>::Dcsc (IT * colptrs, IT * rowinds, NT * vals, IT ncols, IT nonzeros):
-    nz(nonzeros)
+    nz(nonzeros), memowned(true)
 {
         IT cur = colptrs[0];
         IT emptycols = 0;
@@ -380,16 +380,17 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::operator=(const Dcsc<IT,NT> & rhs)
 	if(this != &rhs)		
 	{
 		// make empty first !
-		if(nz > 0)
+		if(nz > 0 && memowned)
 		{
 			delete[] numx;
 			delete[] ir;	
 		}
-		if(nzc > 0)
+		if(nzc > 0 && memowned)
 		{
 			delete[] jc;
 			delete[] cp;
 		}
+		memowned = true;
 		nz = rhs.nz;
 		nzc = rhs.nzc;
 		if(nz > 0)
@@ -646,7 +647,8 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneI(_UnaryOperation __unary_op, bool inPlace, Globa
 	if (inPlace)
 	{
 		// delete the memory pointed by previous pointers
-		DeleteAll(oldnumx, oldir, oldjc, oldcp);
+		if(memowned) DeleteAll(oldnumx, oldir, oldjc, oldcp);
+		memowned = true;
 		nz = cnnz;
 		nzc = cnzc;
 		return NULL;
@@ -727,7 +729,8 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::Prune(_UnaryOperation __unary_op, bool inPlace)
 	if (inPlace)
 	{
 		// delete the memory pointed by previous pointers
-		DeleteAll(oldnumx, oldir, oldjc, oldcp);
+		if(memowned) DeleteAll(oldnumx, oldir, oldjc, oldcp);
+		memowned = true;
 		nz = cnnz;
 		nzc = cnzc;
 		return NULL;
@@ -810,7 +813,8 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(NT* pvals, _BinaryOperation __binary_op, b
     if (inPlace)
     {
         // delete the memory pointed by previous pointers
-        DeleteAll(oldnumx, oldir, oldjc, oldcp);
+        if(memowned) DeleteAll(oldnumx, oldir, oldjc, oldcp);
+        memowned = true;
         nz = cnnz;
         nzc = cnzc;
         return NULL;
@@ -875,10 +879,14 @@ void Dcsc<IT,NT>::PruneColumnByIndex(const std::vector<IT>& ci)
     nzc = vjc.size();
     nz  = vir.size();
 
-    delete [] cp;
-    delete [] jc;
-    delete [] ir;
-    delete [] numx;
+    if(memowned)
+    {
+        delete [] cp;
+        delete [] jc;
+        delete [] ir;
+        delete [] numx;
+    }
+    memowned = true;
 
     cp   = new IT[nzc+1];
     jc   = new IT[nzc];
@@ -975,7 +983,8 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(IT* pinds, NT* pvals, _BinaryOperation __b
     if (inPlace)
     {
         // delete the memory pointed by previous pointers
-        DeleteAll(oldnumx, oldir, oldjc, oldcp);
+        if(memowned) DeleteAll(oldnumx, oldir, oldjc, oldcp);
+        memowned = true;
         nz = cnnz;
         nzc = cnzc;
         return NULL;
@@ -1069,6 +1078,34 @@ IT Dcsc<IT,NT>::ConstructAux(IT ndim, IT * & aux) const
 	return colchunks;
 }
 
+/**
+  * Replaces wrapped (not owned) arrays with owned copies of them
+ **/
+template <class IT, class NT>
+void Dcsc<IT,NT>::TakeOwnership()
+{
+	if(memowned) return;
+	if(nzc > 0)
+	{
+		IT * newcp = new IT[nzc+1];
+		IT * newjc = new IT[nzc];
+		std::copy(cp, cp+nzc+1, newcp);
+		std::copy(jc, jc+nzc, newjc);
+		cp = newcp;
+		jc = newjc;
+	}
+	if(nz > 0)
+	{
+		IT * newir = new IT[nz];
+		NT * newnumx = new NT[nz];
+		std::copy(ir, ir+nz, newir);
+		std::copy(numx, numx+nz, newnumx);
+		ir = newir;
+		numx = newnumx;
+	}
+	memowned = true;
+}
+
 /**
   * Resizes cp & jc arrays to nzcnew, ir & numx arrays to nznew
   * Zero overhead in case sizes stay the same 
@@ -1076,6 +1113,7 @@ IT Dcsc<IT,NT>::ConstructAux(IT ndim, IT * & aux) const
 template <class IT, class NT>
 void Dcsc<IT,NT>::Resize(IT nzcnew, IT nznew)
 {
+	if(!memowned) TakeOwnership();	// the arrays below are reallocated piecewise, so they all need to be ours
 	if(nzcnew == 0)
 	{
 		delete[] jc;
@@ -1426,6 +1464,7 @@ void Dcsc<IT,NT>::FillColInds(const VT * colnums, IT nind, std::vector< std::pai
 template <class IT, class NT>
 Dcsc<IT,NT>::~Dcsc()
 {
+	if(!memowned) return;		// wraps arrays owned by someone else (e.g. a memory mapped file)
 	if(nz > 0)			// dcsc may be empty
 	{
 		delete[] numx;
@@ -109,6 +109,7 @@ public:
 
 	IT ConstructAux(IT ndim, IT * & aux) const;
 	void Resize(IT nzcnew, IT nznew);
+	void TakeOwnership();		//!< copy wrapped arrays into owned memory (no-op if memowned)
 
 	template<class VT>	
 	void FillColInds(const VT * colnums, IT nind, std::vector< std::pair<IT,IT> > & colinds, IT * aux, IT csize) const;
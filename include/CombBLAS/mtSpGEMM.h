@@ -2,6 +2,9 @@
 #define _mtSpGEMM_h
 
 #include "CombBLAS.h"
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace combblas {
 /*
@@ -209,7 +212,375 @@ bool sort_less(const std::pair<IT, NT> &left, const std::pair<IT, NT> &right)
     return left.first < right.first;
 }
 
-// Hybrid approach of multithreaded HeapSpGEMM and HashSpGEMM
+/*
+ * Accumulators available to LocalAdaptiveSpGEMM for a single output column
+ *  - heap: k-way merge of the A columns selected by B(:,j), cheap when few lists are merged
+ *  - hash: linear probing hash table sized to nnz(C(:,j)), followed by a sort
+ *  - spa: cache-blocked dense accumulator over row panels of A, no sort is needed because rows are scanned in order
+ */
+enum LocalAccumulator
+{
+    HEAP_ACCUMULATOR,
+    HASH_ACCUMULATOR,
+    SPA_ACCUMULATOR
+};
+
+/*
+ * Cost model used to pick the accumulator of an output column
+ * Inputs are the symbolic quantities computed by estimateFLOP and estimateNNZ_Hash
+ *    flop: number of multiplications needed for the column
+ *    nnz: number of nonzeros in the column
+ *    nnzcolB: number of nonzeros in the corresponding column of B (number of merged lists)
+ *    mdim: number of rows of the output
+ * The weights are relative costs per operation and can be tuned for a given machine
+ */
+struct LocalAccumulatorCost
+{
+    double heapPerFlop = 1.0;   // multiplied by log2(nnzcolB)
+    double hashPerFlop = 2.0;   // a probe is usually a cache miss for large tables
+    double hashPerSort = 1.0;   // multiplied by nnz*log2(nnz)
+    double spaPerFlop = 1.0;    // direct access to a cache resident array
+    double spaPerRow = 0.03125; // scan of the bitmap to gather the output, one word per 64 rows
+    double spaPerTile = 1.0;    // multiplied by nnzcolB, each panel restarts the scan of the A columns
+    int64_t spaTileRows = 32768;   // rows per panel of the dense accumulator
+    
+    template <typename IT>
+    LocalAccumulator Select(IT flop, IT nnz, IT nnzcolB, IT mdim) const
+    {
+        double lgB = std::log2(std::max(2.0, static_cast<double>(nnzcolB)));
+        double lgC = std::log2(std::max(2.0, static_cast<double>(nnz)));
+        double heapcost = heapPerFlop * flop * lgB;
+        double hashcost = hashPerFlop * flop + hashPerSort * nnz * lgC;
+        double ntiles = std::ceil(static_cast<double>(mdim) / spaTileRows);
+        double spacost = spaPerFlop * flop + spaPerRow * mdim + spaPerTile * nnzcolB * ntiles;
+        
+        if(heapcost <= hashcost && heapcost <= spacost) return HEAP_ACCUMULATOR;
+        else if(hashcost <= spacost) return HASH_ACCUMULATOR;
+        else return SPA_ACCUMULATOR;
+    }
+};
+
+
+/*
+ * Computes the ith nonzero column of C = A*B with a heap
+ * colinds are filled by Dcsc::FillColInds and wset should have space for nnz(B(:,i)) entries
+ * Writes the column to tuplesC starting at curptr and returns the position after the last entry
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+IT HeapAccumulateColumn(const Dcsc<IT,NT1> * Adcsc, const Dcsc<IT,NT2> * Bdcsc, IT i, std::pair<IT,IT> * colinds,
+                        HeapEntry<IT,NT1> * wset, std::tuple<IT,IT,NTO> * tuplesC, IT curptr)
+{
+    IT nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i];
+    IT begptr = curptr;
+    IT hsize = 0;
+    for(IT j = 0; j < nnzcolB; ++j)		// create the initial heap
+    {
+        if(colinds[j].first != colinds[j].second)	// current != end
+        {
+            wset[hsize++] = HeapEntry< IT,NT1 > (Adcsc->ir[colinds[j].first], j, Adcsc->numx[colinds[j].first]);
+        }
+    }
+    std::make_heap(wset, wset+hsize);
+    
+    while(hsize > 0)
+    {
+        std::pop_heap(wset, wset + hsize);         // result is stored in wset[hsize-1]
+        IT locb = wset[hsize-1].runr;	// relative location of the nonzero in B's current column
+        
+        NTO mrhs = SR::multiply(wset[hsize-1].num, Bdcsc->numx[Bdcsc->cp[i]+locb]);
+        if (!SR::returnedSAID())
+        {
+            if( (curptr > begptr) && std::get<0>(tuplesC[curptr-1]) == wset[hsize-1].key)
+            {
+                std::get<2>(tuplesC[curptr-1]) = SR::add(std::get<2>(tuplesC[curptr-1]), mrhs);
+            }
+            else
+            {
+                tuplesC[curptr++]= std::make_tuple(wset[hsize-1].key, Bdcsc->jc[i], mrhs) ;
+            }
+        }
+        if( (++(colinds[locb].first)) != colinds[locb].second)	// current != end
+        {
+            // runr stays the same !
+            wset[hsize-1].key = Adcsc->ir[colinds[locb].first];
+            wset[hsize-1].num = Adcsc->numx[colinds[locb].first];
+            std::push_heap(wset, wset+hsize);
+        }
+        else
+        {
+            --hsize;
+        }
+    }
+    return curptr;
+}
+
+
+/*
+ * Computes the ith nonzero column of C = A*B with a hash table
+ * globalHashVec should have space for at least ht_size entries, which is a power of two >= nnz(C(:,i))
+ * If sort=false, the column is written in hash table order
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+IT HashAccumulateColumn(const Dcsc<IT,NT1> * Adcsc, const Dcsc<IT,NT2> * Bdcsc, IT i, std::pair<IT,IT> * colinds,
+                        std::pair<IT,NTO> * globalHashVec, size_t ht_size, std::tuple<IT,IT,NTO> * tuplesC, IT curptr, bool sort=true)
+{
+    const IT hashScale = 107;
+    IT nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i];
+    
+    for(size_t j=0; j < ht_size; ++j)
+    {
+        globalHashVec[j].first = -1;
+    }
+    
+    // Multiply and add on Hash table
+    for (IT j=0; j < nnzcolB; ++j)
+    {
+        NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
+        for (IT k = colinds[j].first; k < colinds[j].second; ++k)
+        {
+            NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
+            IT key = Adcsc->ir[k];
+            IT hash = (key*hashScale) & (ht_size-1);
+            while (1) //hash probing
+            {
+                if (globalHashVec[hash].first == key) //key is found in hash table
+                {
+                    globalHashVec[hash].second = SR::add(mrhs, globalHashVec[hash].second);
+                    break;
+                }
+                else if (globalHashVec[hash].first == -1) //key is not registered yet
+                {
+                    globalHashVec[hash].first = key;
+                    globalHashVec[hash].second = mrhs;
+                    break;
+                }
+                else //key is not found
+                {
+                    hash = (hash+1) & (ht_size-1);
+                }
+            }
+        }
+    }
+    
+    // gather non-zero elements from hash table, and then sort them by row indices
+    size_t index = 0;
+    for (size_t j=0; j < ht_size; ++j)
+    {
+        if (globalHashVec[j].first != -1)
+        {
+            globalHashVec[index++] = globalHashVec[j];
+        }
+    }
+    if(sort)
+        std::sort(globalHashVec, globalHashVec + index, sort_less<IT, NTO>);
+    for (size_t j=0; j < index; ++j)
+    {
+        tuplesC[curptr++]= std::make_tuple(globalHashVec[j].first, Bdcsc->jc[i], globalHashVec[j].second);
+    }
+    return curptr;
+}
+
+
+/*
+ * Computes the ith nonzero column of C = A*B with a cache-blocked dense accumulator (SPA)
+ * The rows of C are processed in panels of tileRows rows. For each panel, a bitmap and a value
+ * array of tileRows entries are filled and then scanned word by word, which gives the column
+ * sorted by row index without a sort. Both arrays are thread private and should stay in cache.
+ * tileBitmap must be all zeros on entry and is all zeros again on return
+ * colinds are consumed (advanced to their end) by this function
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+IT SpaAccumulateColumn(const Dcsc<IT,NT1> * Adcsc, const Dcsc<IT,NT2> * Bdcsc, IT i, std::pair<IT,IT> * colinds,
+                       NTO * tileValues, uint64_t * tileBitmap, IT tileRows, std::tuple<IT,IT,NTO> * tuplesC, IT curptr)
+{
+    IT nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i];
+    IT minrow = std::numeric_limits<IT>::max();
+    IT maxrow = 0;
+    for (IT j=0; j < nnzcolB; ++j)
+    {
+        if(colinds[j].first != colinds[j].second)   // columns of A are sorted by row index
+        {
+            minrow = std::min(minrow, Adcsc->ir[colinds[j].first]);
+            maxrow = std::max(maxrow, Adcsc->ir[colinds[j].second-1]);
+        }
+    }
+    if(minrow > maxrow) return curptr;
+    
+    for(IT tilestart = (minrow / tileRows) * tileRows; tilestart <= maxrow; tilestart += tileRows)
+    {
+        IT tileend = tilestart + tileRows;
+        for (IT j=0; j < nnzcolB; ++j)
+        {
+            NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
+            IT k = colinds[j].first;
+            for (; k < colinds[j].second && Adcsc->ir[k] < tileend; ++k)
+            {
+                NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
+                IT key = Adcsc->ir[k] - tilestart;
+                uint64_t mask = uint64_t(1) << (key & 63);
+                if(tileBitmap[key >> 6] & mask)
+                {
+                    tileValues[key] = SR::add(tileValues[key], mrhs);
+                }
+                else
+                {
+                    tileBitmap[key >> 6] |= mask;
+                    tileValues[key] = mrhs;
+                }
+            }
+            colinds[j].first = k;
+        }
+        
+        IT nwords = (std::min(tileend, maxrow+1) - tilestart + 63) >> 6;
+        for(IT w = 0; w < nwords; ++w)
+        {
+            uint64_t word = tileBitmap[w];
+            while(word)
+            {
+                IT key = (w << 6) + __builtin_ctzll(word);
+                tuplesC[curptr++] = std::make_tuple(tilestart + key, Bdcsc->jc[i], tileValues[key]);
+                word &= word - 1;
+            }
+            tileBitmap[w] = 0;
+        }
+    }
+    return curptr;
+}
+
+
+/*
+ * Number of consecutive hash table slots compared by one probe of the vectorized hash accumulator
+ * It is decided at compile time: AVX-512 compares 8 64-bit or 16 32-bit keys, AVX2 compares 4 64-bit
+ * or 8 32-bit keys. Otherwise (or for non-integral keys) buckets of 8 slots are scanned by a scalar loop
+ * The CMake options USE_AVX2 and USE_AVX512 add the corresponding compiler flags
+ */
+template <typename IT>
+constexpr int HashBucketWidth()
+{
+#if defined(__AVX512F__)
+    return (std::is_integral<IT>::value && (sizeof(IT) == 8 || sizeof(IT) == 4)) ? 64 / sizeof(IT) : 8;
+#elif defined(__AVX2__)
+    return (std::is_integral<IT>::value && (sizeof(IT) == 8 || sizeof(IT) == 4)) ? 32 / sizeof(IT) : 8;
+#else
+    return 8;
+#endif
+}
+
+/*
+ * Compares key against the HashBucketWidth<IT>() slots starting at bucket
+ * Bit b of keymask (emptymask) is set if slot b holds key (is empty)
+ */
+template <typename IT>
+inline void HashBucketMatch(const IT * bucket, IT key, IT emptykey, uint32_t & keymask, uint32_t & emptymask)
+{
+#if defined(__AVX512F__)
+    if constexpr (std::is_integral<IT>::value && sizeof(IT) == 8)
+    {
+        __m512i slots = _mm512_loadu_si512(bucket);
+        keymask = _mm512_cmpeq_epi64_mask(slots, _mm512_set1_epi64(key));
+        emptymask = _mm512_cmpeq_epi64_mask(slots, _mm512_set1_epi64(emptykey));
+        return;
+    }
+    else if constexpr (std::is_integral<IT>::value && sizeof(IT) == 4)
+    {
+        __m512i slots = _mm512_loadu_si512(bucket);
+        keymask = _mm512_cmpeq_epi32_mask(slots, _mm512_set1_epi32(key));
+        emptymask = _mm512_cmpeq_epi32_mask(slots, _mm512_set1_epi32(emptykey));
+        return;
+    }
+#elif defined(__AVX2__)
+    if constexpr (std::is_integral<IT>::value && sizeof(IT) == 8)
+    {
+        __m256i slots = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bucket));
+        keymask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(slots, _mm256_set1_epi64x(key))));
+        emptymask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(slots, _mm256_set1_epi64x(emptykey))));
+        return;
+    }
+    else if constexpr (std::is_integral<IT>::value && sizeof(IT) == 4)
+    {
+        __m256i slots = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bucket));
+        keymask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(slots, _mm256_set1_epi32(key))));
+        emptymask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(slots, _mm256_set1_epi32(emptykey))));
+        return;
+    }
+#endif
+    keymask = 0;
+    emptymask = 0;
+    for(int b = 0; b < HashBucketWidth<IT>(); ++b)
+    {
+        keymask |= static_cast<uint32_t>(bucket[b] == key) << b;
+        emptymask |= static_cast<uint32_t>(bucket[b] == emptykey) << b;
+    }
+}
+
+/*
+ * Computes the ith nonzero column of C = A*B with a bucketed hash table
+ * Keys and values are kept in separate arrays (htKeys, htValues) of ht_size entries, where ht_size is a
+ * power of two and a multiple of HashBucketWidth<IT>(). A key is hashed to a bucket of consecutive slots
+ * and a whole bucket is compared in one probe. Keys are inserted into the first empty slot, so a key that
+ * is not found in a bucket with an empty slot is not in the table.
+ * If sort=false, the column is written in hash table order
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+IT SimdHashAccumulateColumn(const Dcsc<IT,NT1> * Adcsc, const Dcsc<IT,NT2> * Bdcsc, IT i, std::pair<IT,IT> * colinds,
+                            IT * htKeys, NTO * htValues, size_t ht_size, std::tuple<IT,IT,NTO> * tuplesC, IT curptr, bool sort=true)
+{
+    const IT hashScale = 107;
+    const IT emptykey = static_cast<IT>(-1);
+    const size_t width = HashBucketWidth<IT>();
+    const size_t bucketmask = (ht_size-1) & ~(width-1);
+    IT nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i];
+    IT begptr = curptr;
+    
+    std::fill(htKeys, htKeys + ht_size, emptykey);
+    for (IT j=0; j < nnzcolB; ++j)
+    {
+        NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
+        for (IT k = colinds[j].first; k < colinds[j].second; ++k)
+        {
+            NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
+            IT key = Adcsc->ir[k];
+            size_t bucket = static_cast<size_t>(key*hashScale) & bucketmask;
+            while (1) //bucket probing
+            {
+                uint32_t keymask, emptymask;
+                HashBucketMatch(htKeys + bucket, key, emptykey, keymask, emptymask);
+                if(keymask)
+                {
+                    size_t slot = bucket + __builtin_ctz(keymask);
+                    htValues[slot] = SR::add(mrhs, htValues[slot]);
+                    break;
+                }
+                else if(emptymask)
+                {
+                    size_t slot = bucket + __builtin_ctz(emptymask);
+                    htKeys[slot] = key;
+                    htValues[slot] = mrhs;
+                    break;
+                }
+                bucket = (bucket + width) & bucketmask;
+            }
+        }
+    }
+    
+    for (size_t j=0; j < ht_size; ++j)
+    {
+        if (htKeys[j] != emptykey)
+        {
+            tuplesC[curptr++]= std::make_tuple(htKeys[j], Bdcsc->jc[i], htValues[j]);
+        }
+    }
+    if(sort)
+    {
+        std::sort(tuplesC + begptr, tuplesC + curptr, [](const std::tuple<IT,IT,NTO> & a, const std::tuple<IT,IT,NTO> & b)
+                  { return std::get<0>(a) < std::get<0>(b); });
+    }
+    return curptr;
+}
+
+
+// Hybrid approach of multithreaded HeapSpGEMM, HashSpGEMM and dense accumulation
+// Columns whose flop count is at least half of the number of rows use a cache-blocked SPA
 template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
 SpTuples<IT, NTO> * LocalHybridSpGEMM
 (const SpDCCols<IT, NT1> & A,
@@ -277,6 +648,9 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
    
      std::vector<std::vector< std::pair<IT,NTO>>> globalHashVecAll(numThreads); 
      std::vector<std::vector< HeapEntry<IT,NT1>>> globalHeapVecAll(numThreads);
+     std::vector<std::unique_ptr< NTO[] >> spaValuesAll(numThreads);   // not a vector, which would not work for bool
+     std::vector<std::vector< uint64_t >> spaBitmapAll(numThreads);
+     const IT spaTileRows = std::min<IT>(32768, mdim);    // 256KB of doubles plus a 4KB bitmap per thread
     /*
     for(int i=0; i<numThreads; i++) //inital allocation per thread, may be an overestimate, but does not require more memoty than inputs
     {
@@ -308,7 +682,16 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
         std::pair<IT,IT> * colinds = colindsVec[myThread].data();
 
         double cr = static_cast<double>(flopptr[i+1] - flopptr[i]) / (colptrC[i+1] - colptrC[i]);
-        if (cr < 2.0) // Heap Algorithm
+        if (2 * (flopptr[i+1] - flopptr[i]) >= mdim) // Dense accumulator
+        {
+            if(!spaValuesAll[myThread])
+            {
+                spaValuesAll[myThread].reset(new NTO[spaTileRows]);
+                spaBitmapAll[myThread].resize((spaTileRows + 63) / 64, 0);
+            }
+            SpaAccumulateColumn<SR>(Adcsc, Bdcsc, (IT) i, colinds, spaValuesAll[myThread].get(), spaBitmapAll[myThread].data(), spaTileRows, tuplesC, colptrC[i]);
+        }
+        else if (cr < 2.0) // Heap Algorithm
         {
 	    if(globalHeapVecAll[myThread].size() < nnzcolB)
 	    	globalHeapVecAll[myThread].resize(nnzcolB);	    
@@ -459,12 +842,14 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
     return spTuplesC;
 }
 
-    // Hybrid approach of multithreaded HeapSpGEMM and HashSpGEMM
+    // Multithreaded HashSpGEMM
+    // If vectorized=true, the hash tables are probed one bucket of HashBucketWidth<IT>() slots at a time
+    // (see SimdHashAccumulateColumn); otherwise the original scalar linear probing is used
     template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
     SpTuples<IT, NTO> * LocalSpGEMMHash
     (const SpDCCols<IT, NT1> & A,
      const SpDCCols<IT, NT2> & B,
-     bool clearA, bool clearB, bool sort=true)
+     bool clearA, bool clearB, bool sort=true, bool vectorized=true)
     {
 
         double t0=MPI_Wtime();
@@ -517,6 +902,8 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
 
         // thread private space for heap and colinds
         std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
+        std::vector<std::vector< IT >> htKeysAll(numThreads);
+        std::vector<std::unique_ptr< NTO[] >> htValuesAll(numThreads);    // not a vector, which would not work for bool
 
         for(int i=0; i<numThreads; i++) //inital allocation per thread, may be an overestimate, but does not require more memoty than inputs
         {
@@ -560,6 +947,16 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
             {
                 ht_size <<= 1;
             }
+            if(vectorized)
+            {
+                if(htKeysAll[myThread].size() < ht_size)
+                {
+                    htKeysAll[myThread].resize(ht_size);
+                    htValuesAll[myThread].reset(new NTO[ht_size]);
+                }
+                SimdHashAccumulateColumn<SR>(Adcsc, Bdcsc, (IT) i, colinds, htKeysAll[myThread].data(), htValuesAll[myThread].get(), ht_size, tuplesC, colptrC[i], sort);
+                continue;
+            }
             std::vector< std::pair<IT,NTO>> globalHashVec(ht_size);
 
             // colinds.first vector keeps indices to A.cp, i.e. it dereferences "colnums" vector (above),
@@ -655,6 +1052,546 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
         return spTuplesC;
     }
 
+/*
+ * Multithreaded local SpGEMM that picks the accumulator for every output column at run time
+ * Columns are first classified with LocalAccumulatorCost using the flop and nnz counts from the
+ * symbolic phase, then each bucket of columns is processed with its own kernel so that threads
+ * working on a bucket share the same memory access pattern
+ * The output columns are sorted by row index
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+SpTuples<IT, NTO> * LocalAdaptiveSpGEMM
+(const SpDCCols<IT, NT1> & A,
+ const SpDCCols<IT, NT2> & B,
+ bool clearA, bool clearB, IT * aux = nullptr, const LocalAccumulatorCost & cost = LocalAccumulatorCost())
+{
+    IT mdim = A.getnrow();
+    IT ndim = B.getncol();
+    if(A.isZero() || B.isZero())
+    {
+        return new SpTuples<IT, NTO>(0, mdim, ndim);
+    }
+    
+    Dcsc<IT,NT1>* Adcsc = A.GetDCSC();
+    Dcsc<IT,NT2>* Bdcsc = B.GetDCSC();
+    IT nA = A.getncol();
+    float cf  = static_cast<float>(nA+1) / static_cast<float>(Adcsc->nzc);
+    IT csize = static_cast<IT>(ceil(cf));   // chunk size
+    bool deleteAux = false;
+    if(aux==nullptr)
+    {
+        deleteAux = true;
+        Adcsc->ConstructAux(nA, aux);
+    }
+    
+    int numThreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+    {
+        numThreads = omp_get_num_threads();
+    }
+#endif
+    
+    IT* flopC = estimateFLOP(A, B, aux);
+    IT* colnnzC = estimateNNZ_Hash(A, B, flopC, aux);
+    IT Bnzc = Bdcsc->nzc;
+    
+    // classify columns
+    std::vector<unsigned char> kernel(Bnzc);
+#ifdef THREADED
+#pragma omp parallel for
+#endif
+    for(IT i=0; i < Bnzc; ++i)
+    {
+        kernel[i] = cost.Select(flopC[i], colnnzC[i], Bdcsc->cp[i+1] - Bdcsc->cp[i], mdim);
+    }
+    std::vector<IT> buckets[3];
+    for(IT i=0; i < Bnzc; ++i)
+    {
+        buckets[kernel[i]].push_back(i);
+    }
+    
+    IT* colptrC = prefixsum<IT>(colnnzC, Bnzc, numThreads);
+    delete [] colnnzC;
+    delete [] flopC;
+    IT nnzc = colptrC[Bnzc];
+    
+    std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (::operator new (sizeof(std::tuple<IT,IT,NTO>[nnzc])));
+    
+    // thread private space, only allocated for the accumulators that are used
+    std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
+    std::vector<std::vector< HeapEntry<IT,NT1>>> globalHeapVecAll(numThreads);
+    std::vector<std::vector< std::pair<IT,NTO>>> globalHashVecAll(numThreads);
+    IT tileRows = std::min<IT>(cost.spaTileRows, mdim);
+    std::vector<std::unique_ptr< NTO[] >> spaValuesAll(numThreads);   // not a vector, which would not work for bool
+    std::vector<std::vector< uint64_t >> spaBitmapAll(numThreads);
+    
+    for(int b = 0; b < 3; ++b)
+    {
+        IT nbucket = buckets[b].size();
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for(IT k=0; k < nbucket; ++k)
+        {
+            IT i = buckets[b][k];
+            size_t nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i]; //nnz in the current column of B
+            int myThread = 0;
+#ifdef THREADED
+            myThread = omp_get_thread_num();
+#endif
+            if(colindsVec[myThread].size() < nnzcolB) //resize thread private vectors if needed
+            {
+                colindsVec[myThread].resize(nnzcolB);
+            }
+            Adcsc->FillColInds(Bdcsc->ir + Bdcsc->cp[i], nnzcolB, colindsVec[myThread], aux, csize);
+            std::pair<IT,IT> * colinds = colindsVec[myThread].data();
+            
+            if(b == HEAP_ACCUMULATOR)
+            {
+                if(globalHeapVecAll[myThread].size() < nnzcolB)
+                    globalHeapVecAll[myThread].resize(nnzcolB);
+                HeapAccumulateColumn<SR>(Adcsc, Bdcsc, i, colinds, globalHeapVecAll[myThread].data(), tuplesC, colptrC[i]);
+            }
+            else if(b == HASH_ACCUMULATOR)
+            {
+                size_t nnzcolC = colptrC[i+1] - colptrC[i];
+                size_t ht_size = 16;
+                while(ht_size < nnzcolC) //ht_size is set as 2^n
+                {
+                    ht_size <<= 1;
+                }
+                if(globalHashVecAll[myThread].size() < ht_size)
+                    globalHashVecAll[myThread].resize(ht_size);
+                HashAccumulateColumn<SR>(Adcsc, Bdcsc, i, colinds, globalHashVecAll[myThread].data(), ht_size, tuplesC, colptrC[i]);
+            }
+            else
+            {
+                if(!spaValuesAll[myThread])
+                {
+                    spaValuesAll[myThread].reset(new NTO[tileRows]);
+                    spaBitmapAll[myThread].resize((tileRows + 63) / 64, 0);
+                }
+                SpaAccumulateColumn<SR>(Adcsc, Bdcsc, i, colinds, spaValuesAll[myThread].get(), spaBitmapAll[myThread].data(), tileRows, tuplesC, colptrC[i]);
+            }
+        }
+    }
+    
+    if(clearA)
+        delete const_cast<SpDCCols<IT, NT1> *>(&A);
+    if(clearB)
+        delete const_cast<SpDCCols<IT, NT2> *>(&B);
+    
+    delete [] colptrC;
+    if(deleteAux)
+        delete [] aux;
+    
+#ifdef COMBBLAS_DEBUG
+    std::ostringstream outs;
+    outs << "LocalAdaptiveSpGEMM columns (heap, hash, spa): " << buckets[HEAP_ACCUMULATOR].size() << ", " << buckets[HASH_ACCUMULATOR].size() << ", " << buckets[SPA_ACCUMULATOR].size() << std::endl;
+    std::cout << outs.str();
+#endif
+    return new SpTuples<IT, NTO> (nnzc, mdim, ndim, tuplesC, true, true);
+}
+
+
+/*
+ * Column filter of the fused MCL expansion (LocalSpGEMMPruneSelect and MultiwayMergePruneSelect)
+ * MCLPruneRecoverySelect only keeps entries of a column that are among its max(selectNum, recoverNum) largest,
+ * or, when there is no selection, entries that are not below the hard threshold. The top-k of a column that is
+ * split across a processor column is contained in the union of the local top-k's, hence everything else can be
+ * dropped before the column is ever written out. Pruning decisions depend on the unfiltered columns though,
+ * so their statistics are recorded here (indexed by local column) for MCLPruneRecoverySelect.
+ */
+template <typename IT, typename NT>
+class PruneSelectFilter
+{
+public:
+    PruneSelectFilter(NT hardThreshold, IT selectNum, IT recoverNum, IT ndim):
+    hardThreshold(hardThreshold), selectNum(selectNum), recoverNum(recoverNum),
+    prunedSums(ndim, 0), prunedNnz(ndim, 0), unprunedNnz(ndim, 0) {}
+    
+    // Reorders the len entries of a single column so that the ones to keep come first, sorted by row index
+    // Returns the number of entries to keep
+    IT Filter(std::tuple<IT,IT,NT> * col, IT len)
+    {
+        if(len == 0) return 0;
+        IT j = std::get<1>(col[0]);
+        NT sum = 0;
+        IT nprunedcol = 0;
+        for(IT k=0; k < len; ++k)
+        {
+            if(std::get<2>(col[k]) > hardThreshold)
+            {
+                sum += std::get<2>(col[k]);
+                ++nprunedcol;
+            }
+        }
+        prunedSums[j] = sum;
+        prunedNnz[j] = static_cast<NT>(nprunedcol);
+        unprunedNnz[j] = static_cast<NT>(len);
+        
+        // largest topk entries, including those tied with the smallest of them, are kept
+        IT topk = (selectNum > 0) ? std::max(selectNum, recoverNum) : recoverNum;
+        IT nkeep = 0;
+        if(topk > 0)
+        {
+            if(len > topk)
+            {
+                std::nth_element(col, col + topk - 1, col + len,
+                                 [](const std::tuple<IT,IT,NT> & a, const std::tuple<IT,IT,NT> & b){ return std::get<2>(a) > std::get<2>(b); });
+                NT kth = std::get<2>(col[topk-1]);
+                nkeep = std::partition(col + topk, col + len, [kth](const std::tuple<IT,IT,NT> & a){ return std::get<2>(a) >= kth; }) - col;
+            }
+            else nkeep = len;
+        }
+        // without selection, or if this column is too short to be selected, the final prune keeps everything
+        // at or above the hard threshold (ties included), which may be more than topk entries
+        if(selectNum <= 0 || nprunedcol <= selectNum)
+        {
+            NT threshold = hardThreshold;
+            nkeep = std::partition(col + nkeep, col + len, [threshold](const std::tuple<IT,IT,NT> & a){ return std::get<2>(a) >= threshold; }) - col;
+        }
+        std::sort(col, col + nkeep, [](const std::tuple<IT,IT,NT> & a, const std::tuple<IT,IT,NT> & b){ return std::get<0>(a) < std::get<0>(b); });
+        return nkeep;
+    }
+    
+    NT hardThreshold;
+    IT selectNum;
+    IT recoverNum;
+    std::vector<NT> prunedSums;     // sum of the entries above hardThreshold
+    std::vector<NT> prunedNnz;      // number of entries above hardThreshold
+    std::vector<NT> unprunedNnz;    // number of entries
+};
+
+
+/*
+ * Concatenates per split outputs, where split i holds consecutive columns that precede those of split i+1
+ */
+template <typename IT, typename NT>
+SpTuples<IT, NT> * ConcatenateColumnSplits(std::vector< std::vector< std::tuple<IT,IT,NT> > > & splits, IT mdim, IT ndim)
+{
+    int nsplits = splits.size();
+    std::vector<IT> disp(nsplits+1, 0);
+    for(int s=0; s < nsplits; ++s)
+        disp[s+1] = disp[s] + splits[s].size();
+    IT nnzc = disp[nsplits];
+    std::tuple<IT,IT,NT> * tuplesC = static_cast<std::tuple<IT,IT,NT> *> (::operator new (sizeof(std::tuple<IT,IT,NT>[nnzc])));
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int s=0; s < nsplits; ++s)
+    {
+        std::copy(splits[s].begin(), splits[s].end(), tuplesC + disp[s]);
+        std::vector< std::tuple<IT,IT,NT> >().swap(splits[s]);
+    }
+    return new SpTuples<IT, NT> (nnzc, mdim, ndim, tuplesC, true, true);
+}
+
+
+/*
+ * C = A*B fused with the column filter of the MCL expansion (see PruneSelectFilter)
+ * Each column is accumulated in a hash table, filtered while it is still in thread private space,
+ * and only the surviving entries are written out. Unlike LocalSpGEMMHash, no symbolic phase is needed.
+ * Only exact if C is final, i.e., no other partial product contributes to it (single SUMMA stage)
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+SpTuples<IT, NTO> * LocalSpGEMMPruneSelect
+(const SpDCCols<IT, NT1> & A,
+ const SpDCCols<IT, NT2> & B,
+ bool clearA, bool clearB, PruneSelectFilter<IT,NTO> & filter)
+{
+    IT mdim = A.getnrow();
+    IT ndim = B.getncol();
+    if(A.isZero() || B.isZero())
+    {
+        return new SpTuples<IT, NTO>(0, mdim, ndim);
+    }
+    
+    Dcsc<IT,NT1>* Adcsc = A.GetDCSC();
+    Dcsc<IT,NT2>* Bdcsc = B.GetDCSC();
+    IT nA = A.getncol();
+    float cf  = static_cast<float>(nA+1) / static_cast<float>(Adcsc->nzc);
+    IT csize = static_cast<IT>(ceil(cf));   // chunk size
+    IT * aux;
+    Adcsc->ConstructAux(nA, aux);
+    
+    int numThreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+    {
+        numThreads = omp_get_num_threads();
+    }
+#endif
+    
+    IT* flopC = estimateFLOP(A, B, aux);
+    IT Bnzc = Bdcsc->nzc;
+    int nsplits = std::max(1, static_cast<int>(std::min<IT>(4*numThreads, Bnzc)));  // oversplit for load balance
+    std::vector< std::vector< std::tuple<IT,IT,NTO> > > splits(nsplits);
+    
+    std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
+    std::vector<std::vector< std::pair<IT,NTO>>> globalHashVecAll(numThreads);
+    std::vector<std::vector< std::tuple<IT,IT,NTO>>> columnVecAll(numThreads);
+    
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int s=0; s < nsplits; ++s)
+    {
+        int myThread = 0;
+#ifdef THREADED
+        myThread = omp_get_thread_num();
+#endif
+        IT begcol = (Bnzc / nsplits) * s;
+        IT endcol = (s == nsplits-1) ? Bnzc : (Bnzc / nsplits) * (s+1);
+        for(IT i = begcol; i < endcol; ++i)
+        {
+            size_t nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i]; //nnz in the current column of B
+            if(colindsVec[myThread].size() < nnzcolB) //resize thread private vectors if needed
+            {
+                colindsVec[myThread].resize(nnzcolB);
+            }
+            Adcsc->FillColInds(Bdcsc->ir + Bdcsc->cp[i], nnzcolB, colindsVec[myThread], aux, csize);
+            
+            size_t ht_size = 16;
+            while(ht_size < static_cast<size_t>(flopC[i])) //ht_size is set as 2^n
+            {
+                ht_size <<= 1;
+            }
+            if(globalHashVecAll[myThread].size() < ht_size)
+                globalHashVecAll[myThread].resize(ht_size);
+            if(columnVecAll[myThread].size() < static_cast<size_t>(flopC[i]))
+                columnVecAll[myThread].resize(flopC[i]);
+            
+            IT len = HashAccumulateColumn<SR>(Adcsc, Bdcsc, i, colindsVec[myThread].data(), globalHashVecAll[myThread].data(), ht_size,
+                                              columnVecAll[myThread].data(), static_cast<IT>(0), false);
+            IT nkeep = filter.Filter(columnVecAll[myThread].data(), len);
+            splits[s].insert(splits[s].end(), columnVecAll[myThread].begin(), columnVecAll[myThread].begin() + nkeep);
+        }
+    }
+    
+    if(clearA)
+        delete const_cast<SpDCCols<IT, NT1> *>(&A);
+    if(clearB)
+        delete const_cast<SpDCCols<IT, NT2> *>(&B);
+    
+    delete [] flopC;
+    delete [] aux;
+    
+    return ConcatenateColumnSplits(splits, mdim, ndim);
+}
+
+
+/*
+ * Computes the ith nonzero column of C<M> = A*B (or C<!M> = A*B if complement)
+ * maskRows[0..maskLen) are the (sorted) row indices of the matching column of the mask, whose values are ignored.
+ * Without complement, the hash table maps the mask rows to their positions and contributions to other rows are
+ * dropped before they are multiplied, so the column comes out sorted without a sort and nothing outside the mask
+ * is ever accumulated. With complement, the mask rows are registered as forbidden keys of the accumulator instead.
+ * ht_size is a power of two > 2*maskLen (masked) or >= maskLen + flops (complemented)
+ * accum needs maskLen entries (masked: set flag and value per mask row) or flops entries (complemented: row and value)
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2>
+IT MaskedAccumulateColumn(const Dcsc<IT,NT1> * Adcsc, const Dcsc<IT,NT2> * Bdcsc, IT i, std::pair<IT,IT> * colinds,
+                          const IT * maskRows, IT maskLen, bool complement,
+                          std::pair<IT,IT> * globalHashVec, size_t ht_size, std::pair<IT,NTO> * accum,
+                          std::vector< std::tuple<IT,IT,NTO> > & out)
+{
+    const IT hashScale = 107;
+    IT nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i];
+    IT j = Bdcsc->jc[i];
+    
+    for(size_t h=0; h < ht_size; ++h)
+    {
+        globalHashVec[h].first = -1;
+    }
+    for(IT m=0; m < maskLen; ++m)   // register the mask rows, with their position or as forbidden (-1)
+    {
+        IT key = maskRows[m];
+        IT hash = (key*hashScale) & (ht_size-1);
+        while(globalHashVec[hash].first != -1)
+            hash = (hash+1) & (ht_size-1);
+        globalHashVec[hash].first = key;
+        globalHashVec[hash].second = complement ? -1 : m;
+        if(!complement) accum[m].first = 0;
+    }
+    
+    IT nnzcol = 0;
+    for (IT l=0; l < nnzcolB; ++l)
+    {
+        NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + l];
+        for (IT k = colinds[l].first; k < colinds[l].second; ++k)
+        {
+            IT key = Adcsc->ir[k];
+            IT hash = (key*hashScale) & (ht_size-1);
+            while (globalHashVec[hash].first != key && globalHashVec[hash].first != -1)
+            {
+                hash = (hash+1) & (ht_size-1);
+            }
+            if(!complement)
+            {
+                if(globalHashVec[hash].first == -1) continue;   // outside the mask
+                IT pos = globalHashVec[hash].second;
+                NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
+                if(accum[pos].first)
+                    accum[pos].second = SR::add(mrhs, accum[pos].second);
+                else
+                {
+                    accum[pos].second = mrhs;
+                    accum[pos].first = 1;
+                }
+            }
+            else
+            {
+                if(globalHashVec[hash].first == -1)     // not registered yet
+                {
+                    globalHashVec[hash].first = key;
+                    globalHashVec[hash].second = nnzcol;
+                    accum[nnzcol].first = key;
+                    accum[nnzcol++].second = SR::multiply(Adcsc->numx[k], t_bval);
+                }
+                else if(globalHashVec[hash].second != -1)
+                {
+                    IT pos = globalHashVec[hash].second;
+                    accum[pos].second = SR::add(SR::multiply(Adcsc->numx[k], t_bval), accum[pos].second);
+                }
+            }
+        }
+    }
+    
+    IT curptr = out.size();
+    if(!complement)
+    {
+        for(IT m=0; m < maskLen; ++m)
+        {
+            if(accum[m].first)
+                out.push_back(std::make_tuple(maskRows[m], j, accum[m].second));
+        }
+    }
+    else
+    {
+        for(IT m=0; m < nnzcol; ++m)
+            out.push_back(std::make_tuple(accum[m].first, j, accum[m].second));
+        std::sort(out.begin() + curptr, out.end(),
+                  [](const std::tuple<IT,IT,NTO> & a, const std::tuple<IT,IT,NTO> & b){ return std::get<0>(a) < std::get<0>(b); });
+    }
+    return static_cast<IT>(out.size()) - curptr;
+}
+
+
+/*
+ * Masked local multiplication C<M> = A*B, or C<!M> = A*B if complement
+ * Only the sparsity structure of M (mdim-by-ndim) is used. Without complement, columns of B whose mask
+ * column is empty are skipped altogether and each output column has at most nnz(M(:,j)) entries, hence
+ * the cost of the unmasked product is never paid in memory. Output columns are sorted by row index.
+ */
+template <typename SR, typename NTO, typename IT, typename NT1, typename NT2, typename NTM>
+SpTuples<IT, NTO> * LocalSpGEMMMasked
+(const SpDCCols<IT, NT1> & A,
+ const SpDCCols<IT, NT2> & B,
+ const SpDCCols<IT, NTM> & M,
+ bool complement, bool clearA, bool clearB)
+{
+    IT mdim = A.getnrow();
+    IT ndim = B.getncol();
+    if(A.isZero() || B.isZero() || (M.isZero() && !complement))
+    {
+        if(clearA)
+            delete const_cast<SpDCCols<IT, NT1> *>(&A);
+        if(clearB)
+            delete const_cast<SpDCCols<IT, NT2> *>(&B);
+        return new SpTuples<IT, NTO>(0, mdim, ndim);
+    }
+    
+    Dcsc<IT,NT1>* Adcsc = A.GetDCSC();
+    Dcsc<IT,NT2>* Bdcsc = B.GetDCSC();
+    Dcsc<IT,NTM>* Mdcsc = M.GetDCSC();   // NULL if M is empty
+    IT Mnzc = (M.isZero() || Mdcsc == NULL) ? 0 : Mdcsc->nzc;
+    IT nA = A.getncol();
+    float cf  = static_cast<float>(nA+1) / static_cast<float>(Adcsc->nzc);
+    IT csize = static_cast<IT>(ceil(cf));   // chunk size
+    IT * aux;
+    Adcsc->ConstructAux(nA, aux);
+    
+    int numThreads = 1;
+#ifdef THREADED
+#pragma omp parallel
+    {
+        numThreads = omp_get_num_threads();
+    }
+#endif
+    
+    IT* flopC = estimateFLOP(A, B, aux);
+    IT Bnzc = Bdcsc->nzc;
+    int nsplits = std::max(1, static_cast<int>(std::min<IT>(4*numThreads, Bnzc)));  // oversplit for load balance
+    std::vector< std::vector< std::tuple<IT,IT,NTO> > > splits(nsplits);
+    
+    std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
+    std::vector<std::vector< std::pair<IT,IT>>> globalHashVecAll(numThreads);
+    std::vector<std::vector< std::pair<IT,NTO>>> accumVecAll(numThreads);
+    
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int s=0; s < nsplits; ++s)
+    {
+        int myThread = 0;
+#ifdef THREADED
+        myThread = omp_get_thread_num();
+#endif
+        IT begcol = (Bnzc / nsplits) * s;
+        IT endcol = (s == nsplits-1) ? Bnzc : (Bnzc / nsplits) * (s+1);
+        // both column lists are sorted, so the mask columns are walked along with those of B
+        IT mcol = (Mnzc == 0 || begcol == endcol) ? 0 : std::lower_bound(Mdcsc->jc, Mdcsc->jc + Mnzc, Bdcsc->jc[begcol]) - Mdcsc->jc;
+        for(IT i = begcol; i < endcol; ++i)
+        {
+            if(flopC[i] == 0) continue;
+            while(mcol < Mnzc && Mdcsc->jc[mcol] < Bdcsc->jc[i]) ++mcol;
+            const IT * maskRows = NULL;
+            IT maskLen = 0;
+            if(mcol < Mnzc && Mdcsc->jc[mcol] == Bdcsc->jc[i])
+            {
+                maskRows = Mdcsc->ir + Mdcsc->cp[mcol];
+                maskLen = Mdcsc->cp[mcol+1] - Mdcsc->cp[mcol];
+            }
+            if(maskLen == 0 && !complement) continue;
+            
+            size_t nnzcolB = Bdcsc->cp[i+1] - Bdcsc->cp[i]; //nnz in the current column of B
+            if(colindsVec[myThread].size() < nnzcolB) //resize thread private vectors if needed
+            {
+                colindsVec[myThread].resize(nnzcolB);
+            }
+            Adcsc->FillColInds(Bdcsc->ir + Bdcsc->cp[i], nnzcolB, colindsVec[myThread], aux, csize);
+            
+            size_t ht_size = 16;
+            size_t ht_min = complement ? static_cast<size_t>(maskLen + flopC[i]) : static_cast<size_t>(2*maskLen + 1);
+            while(ht_size < ht_min) //ht_size is set as 2^n
+            {
+                ht_size <<= 1;
+            }
+            if(globalHashVecAll[myThread].size() < ht_size)
+                globalHashVecAll[myThread].resize(ht_size);
+            size_t valsize = complement ? static_cast<size_t>(flopC[i]) : static_cast<size_t>(maskLen);
+            if(accumVecAll[myThread].size() < valsize)
+                accumVecAll[myThread].resize(valsize);
+            
+            MaskedAccumulateColumn<SR>(Adcsc, Bdcsc, i, colindsVec[myThread].data(), maskRows, maskLen, complement,
+                                       globalHashVecAll[myThread].data(), ht_size, accumVecAll[myThread].data(), splits[s]);
+        }
+    }
+    
+    if(clearA)
+        delete const_cast<SpDCCols<IT, NT1> *>(&A);
+    if(clearB)
+        delete const_cast<SpDCCols<IT, NT2> *>(&B);
+    
+    delete [] flopC;
+    delete [] aux;
+    
+    return ConcatenateColumnSplits(splits, mdim, ndim);
+}
+
+
 /*
  *  Estimates total flops necessary to multiply A and B
  *  Then returns the number
@@ -1314,6 +2251,28 @@ LocalHybridSpGEMM (const SpCCols<IT, NT1>	&A,
 }
 
 
+/*
+ * The per-column classification of LocalAdaptiveSpGEMM works on the DCSC arrays,
+ * SpCCols operands use the hybrid kernel instead
+ */
+template <typename SR,
+		  typename NTO,
+		  typename IT,
+		  typename NT1,
+		  typename NT2>
+SpTuples <IT, NTO> *
+LocalAdaptiveSpGEMM (const SpCCols<IT, NT1>	&A,
+					 const SpCCols<IT, NT2>	&B,
+					 bool					 clearA,
+					 bool					 clearB,
+					 IT *					 = nullptr,
+					 const LocalAccumulatorCost & = LocalAccumulatorCost()
+					 )
+{
+	return LocalHybridSpGEMM<SR, NTO>(A, B, clearA, clearB);
+}
+
+
 
 template <typename IT,
 		  typename NT1,